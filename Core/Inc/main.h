@@ -61,6 +61,14 @@ void Error_Handler(void);
 #define B1_Pin GPIO_PIN_13
 #define B1_GPIO_Port GPIOC
 #define B1_EXTI_IRQn EXTI15_10_IRQn
+#define LED_PACKS_0_Pin GPIO_PIN_0
+#define LED_PACKS_0_GPIO_Port GPIOC
+#define LED_PACKS_1_Pin GPIO_PIN_1
+#define LED_PACKS_1_GPIO_Port GPIOC
+#define LED_PACKS_2_Pin GPIO_PIN_2
+#define LED_PACKS_2_GPIO_Port GPIOC
+#define LED_PACKS_3_Pin GPIO_PIN_3
+#define LED_PACKS_3_GPIO_Port GPIOC
 #define USART_TX_Pin GPIO_PIN_2
 #define USART_TX_GPIO_Port GPIOA
 #define USART_RX_Pin GPIO_PIN_3
@@ -71,6 +79,14 @@ void Error_Handler(void);
 #define B4_GPIO_Port GPIOC
 #define D6_Pin GPIO_PIN_10
 #define D6_GPIO_Port GPIOB
+#define LED_SPEED_0_Pin GPIO_PIN_12
+#define LED_SPEED_0_GPIO_Port GPIOB
+#define LED_SPEED_1_Pin GPIO_PIN_13
+#define LED_SPEED_1_GPIO_Port GPIOB
+#define LED_SPEED_2_Pin GPIO_PIN_14
+#define LED_SPEED_2_GPIO_Port GPIOB
+#define LED_SPEED_3_Pin GPIO_PIN_15
+#define LED_SPEED_3_GPIO_Port GPIOB
 #define B5_Pin GPIO_PIN_6
 #define B5_GPIO_Port GPIOC
 #define B6_Pin GPIO_PIN_8
@@ -0,0 +1,61 @@
+/**
+ ******************************************************************************
+ * @file      sysmem.h
+ * @brief     Heap instrumentation of sysmem.c
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SYSMEM_H
+#define __SYSMEM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Debug builds count and locate allocations (the Debug configuration links
+ * with -Wl,--wrap=_malloc_r). Other builds are strict: any allocation or
+ * free once sysmem_seal() has been called traps
+ */
+#ifdef DEBUG
+#define SYSMEM_CONFIG_STRICT  (0)
+#else
+#define SYSMEM_CONFIG_STRICT  (1)
+#endif
+
+/** Call sites kept, the ones beyond are only counted */
+#define SYSMEM_SITE_QTY       (8)
+
+typedef struct
+{
+  uint32_t site;    /* Return address of the _malloc_r call */
+  uint32_t cnt;
+  uint32_t bytes;   /* Requested */
+} sysmem_site_t;
+
+typedef struct
+{
+  uint32_t brk;           /* Heap taken from _end through _sbrk, bytes */
+  uint32_t brk_peak;
+  uint32_t sbrk_cnt;
+  uint32_t fail_cnt;      /* _sbrk requests refused (ENOMEM) */
+  uint32_t alloc_cnt;     /* _malloc_r calls, debug builds */
+  uint32_t late_cnt;      /* Of them after sysmem_seal() */
+  uint32_t site_lost_cnt; /* Calls from sites not kept */
+} sysmem_stat_t;
+
+extern sysmem_stat_t sysmem_stat;
+extern sysmem_site_t sysmem_site_list[SYSMEM_SITE_QTY];
+
+void sysmem_seal(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SYSMEM_H */
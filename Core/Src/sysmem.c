@@ -24,12 +24,42 @@
 /* Includes */
 #include <errno.h>
 #include <stdint.h>
+#include <stddef.h>
+#include <reent.h>
+#include "main.h"
+#include "sysmem.h"
 
 /**
  * Pointer to the current high watermark of the heap usage
  */
 static uint8_t *__sbrk_heap_end = NULL;
 
+/**
+ * Set by sysmem_seal() once the application is initialized
+ */
+static bool sysmem_sealed = false;
+
+sysmem_stat_t sysmem_stat;
+sysmem_site_t sysmem_site_list[SYSMEM_SITE_QTY];
+
+/**
+ * @brief Stops in the debugger, HardFault without it
+ */
+static void sysmem_trap(void)
+{
+  __BKPT(0);
+}
+
+/**
+ * @brief sysmem_seal() is called at the end of app_init(): from there on the
+ *        loop must not allocate. Strict builds trap, debug builds count the
+ *        late allocations
+ */
+void sysmem_seal(void)
+{
+  sysmem_sealed = true;
+}
+
 /**
  * @brief _sbrk() allocates memory to the newlib heap and is used by malloc
  *        and others from the C library
@@ -56,8 +86,8 @@ void *_sbrk(ptrdiff_t incr)
   extern uint8_t _end; /* Symbol defined in the linker script */
   extern uint8_t _estack; /* Symbol defined in the linker script */
   extern uint32_t _Min_Stack_Size; /* Symbol defined in the linker script */
-  const uint32_t stack_limit = (uint32_t)&_estack - (uint32_t)&_Min_Stack_Size;
-  const uint8_t *max_heap = (uint8_t *)stack_limit;
+  const uint32_t stack_limit = (uint32_t)((uintptr_t)&_estack - (uintptr_t)&_Min_Stack_Size);
+  const uint8_t *max_heap = (uint8_t *)(uintptr_t)stack_limit;
   uint8_t *prev_heap_end;
 
   /* Initialize heap end at first call */
@@ -66,9 +96,17 @@ void *_sbrk(ptrdiff_t incr)
     __sbrk_heap_end = &_end;
   }
 
+#if (1 == SYSMEM_CONFIG_STRICT)
+  if (sysmem_sealed)
+  {
+    sysmem_trap();
+  }
+#endif
+
   /* Protect heap from growing into the reserved MSP stack */
   if (__sbrk_heap_end + incr > max_heap)
   {
+    sysmem_stat.fail_cnt++;
     errno = ENOMEM;
     return (void *)-1;
   }
@@ -76,5 +114,71 @@ void *_sbrk(ptrdiff_t incr)
   prev_heap_end = __sbrk_heap_end;
   __sbrk_heap_end += incr;
 
+  sysmem_stat.sbrk_cnt++;
+  sysmem_stat.brk = (uint32_t)(__sbrk_heap_end - &_end);
+  if (sysmem_stat.brk_peak < sysmem_stat.brk)
+  {
+    sysmem_stat.brk_peak = sysmem_stat.brk;
+  }
+
   return (void *)prev_heap_end;
 }
+
+#if (1 == SYSMEM_CONFIG_STRICT)
+/**
+ * @brief newlib takes this lock on every malloc, free and realloc, so a
+ *        sealed strict build traps even when the free list could serve the
+ *        request without _sbrk
+ */
+void __malloc_lock(struct _reent *r)
+{
+  (void)r;
+
+  if (sysmem_sealed)
+  {
+    sysmem_trap();
+  }
+}
+
+void __malloc_unlock(struct _reent *r)
+{
+  (void)r;
+}
+#else
+void *__real__malloc_r(struct _reent *r, size_t size);
+
+/**
+ * @brief Every allocation, libc internals (stdio buffers) included. malloc()
+ *        tail-calls _malloc_r, so the return address is the caller of
+ *        malloc() itself
+ */
+void *__wrap__malloc_r(struct _reent *r, size_t size)
+{
+  const uint32_t site = (uint32_t)(uintptr_t)__builtin_return_address(0);
+  uint32_t index;
+
+  sysmem_stat.alloc_cnt++;
+  if (sysmem_sealed)
+  {
+    sysmem_stat.late_cnt++;
+  }
+
+  for (index = 0; index < SYSMEM_SITE_QTY; index++)
+  {
+    if ((0 == sysmem_site_list[index].cnt) || (site == sysmem_site_list[index].site))
+    {
+      sysmem_site_list[index].site = site;
+      sysmem_site_list[index].cnt++;
+      sysmem_site_list[index].bytes += size;
+      break;
+    }
+  }
+
+  if (SYSMEM_SITE_QTY == index)
+  {
+    sysmem_stat.site_lost_cnt++;
+  }
+
+  return __real__malloc_r(r, size);
+}
+#endif
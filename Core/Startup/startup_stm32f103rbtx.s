@@ -94,6 +94,21 @@ LoopFillZerobss:
   cmp r2, r4
   bcc FillZerobss
 
+/* Paint the free RAM up to the stack pointer, STACK_MONITOR_PAINT in
+   app/inc/stack_monitor.h */
+  ldr r2, =_end
+  ldr r3, =0xDEADBEEF
+  mov r4, sp
+  b LoopPaintStack
+
+PaintStack:
+  str  r3, [r2]
+  adds r2, r2, #4
+
+LoopPaintStack:
+  cmp r2, r4
+  bcc PaintStack
+
 /* Call static constructors */
     bl __libc_init_array
 /* Call the application's entry point.*/
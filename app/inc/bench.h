@@ -0,0 +1,77 @@
+/*
+ * bench.h
+ *
+ */
+
+#ifndef INC_BENCH_H_
+#define INC_BENCH_H_
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "main.h"
+
+/********************** macros ***********************************************/
+
+/* 1: app_init() runs the suite before the tasks start (benchmark build).
+ * The host build runs it with sim/build/app_sim -b */
+#define BENCH_CONFIG_ENABLE			(0)
+
+/* Ticks run per scenario */
+#define BENCH_CONFIG_RUNS			1000ul
+
+/* CYCCNT on the target. The host build (sim/Makefile) counts TSC ticks
+ * instead, CYCCNT is simulated there */
+#ifndef BENCH_CYCLES_GET
+#define BENCH_CYCLES_GET()			(DWT->CYCCNT)
+#endif
+
+/********************** typedef **********************************************/
+
+/* Registry of scenarios and measured items, names in bench.c */
+typedef enum bench_scenario {BENCH_SCENARIO_IDLE,			// No events
+							 BENCH_SCENARIO_PACK_BURST,		// A pack event per tick, buffer filled & drained
+							 BENCH_SCENARIO_SETUP_NAV,		// A setup key per tick, through both menus
+							 BENCH_SCENARIO_QTY} bench_scenario_t;
+
+typedef enum bench_item {BENCH_ITEM_SENSOR,
+						 BENCH_ITEM_NORMAL,
+						 BENCH_ITEM_SETUP,
+						 BENCH_ITEM_ACTUATOR,
+						 BENCH_ITEM_TICK,				// The four tasks above
+						 BENCH_ITEM_PUT_NORMAL,
+						 BENCH_ITEM_GET_NORMAL,
+						 BENCH_ITEM_PUT_SETUP,
+						 BENCH_ITEM_GET_SETUP,
+						 BENCH_ITEM_QTY} bench_item_t;
+
+typedef struct
+{
+	uint32_t	cnt;
+	uint64_t	total;
+	uint32_t	min;
+	uint32_t	max;
+} bench_result_t;
+
+/********************** external data declaration ****************************/
+extern bench_result_t bench_result_list[BENCH_SCENARIO_QTY][BENCH_ITEM_QTY];
+
+/********************** external functions declaration ***********************/
+extern void bench_run(void);
+extern void bench_dump(void);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_BENCH_H_ */
+
+/********************** end of file ******************************************/
@@ -104,6 +104,32 @@ extern "C" {
 #define LED_A_ON		GPIO_PIN_SET
 #define LED_A_OFF		GPIO_PIN_RESET
 
+/* Bar graph LEDs, only wired on the NUCLEO-F103RC (LED_xxx_x of main.h) */
+#if (BOARD == NUCLEO_F103RC)
+
+#define LED_PACKS_0_PIN		LED_PACKS_0_Pin
+#define LED_PACKS_0_PORT	LED_PACKS_0_GPIO_Port
+#define LED_PACKS_1_PIN		LED_PACKS_1_Pin
+#define LED_PACKS_1_PORT	LED_PACKS_1_GPIO_Port
+#define LED_PACKS_2_PIN		LED_PACKS_2_Pin
+#define LED_PACKS_2_PORT	LED_PACKS_2_GPIO_Port
+#define LED_PACKS_3_PIN		LED_PACKS_3_Pin
+#define LED_PACKS_3_PORT	LED_PACKS_3_GPIO_Port
+
+#define LED_SPEED_0_PIN		LED_SPEED_0_Pin
+#define LED_SPEED_0_PORT	LED_SPEED_0_GPIO_Port
+#define LED_SPEED_1_PIN		LED_SPEED_1_Pin
+#define LED_SPEED_1_PORT	LED_SPEED_1_GPIO_Port
+#define LED_SPEED_2_PIN		LED_SPEED_2_Pin
+#define LED_SPEED_2_PORT	LED_SPEED_2_GPIO_Port
+#define LED_SPEED_3_PIN		LED_SPEED_3_Pin
+#define LED_SPEED_3_PORT	LED_SPEED_3_GPIO_Port
+
+#define LED_BAR_ON		GPIO_PIN_SET
+#define LED_BAR_OFF		GPIO_PIN_RESET
+
+#endif
+
 #endif/* STM32 Nucleo Boards - 144 Pins */
 
 #if ((BOARD == NUCLEO_F429ZI) || (BOARD == NUCLEO_F439ZI) || (BOARD == NUCLEO_F413ZH))
@@ -205,6 +231,19 @@ extern "C" {
 
 #endif
 
+/* Task Actuator drives both bar graphs, a board without them needs its own
+ * LED table there */
+#ifndef LED_PACKS_0_PIN
+#error "board.h: no LED_PACKS / LED_SPEED bank on this BOARD"
+#endif
+
+/* Timer channel driving each LED pin, NULL blinks & pulses by software
+ * (LD2 is PA5, which has no timer channel on the F103) */
+#ifndef LED_A_TIM
+#define LED_A_TIM			NULL
+#define LED_A_TIM_CHANNEL	0ul
+#endif
+
 /********************** typedef **********************************************/
 
 /********************** external data declaration ****************************/
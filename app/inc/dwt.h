@@ -74,6 +74,9 @@ extern "C" {
 /* read cycle counter */
 /*!< DWT Cycle Counter register */
 #define cycle_counter_get() (DWT->CYCCNT)
+/* cycles since a previous cycle_counter_get(), right across one wrap */
+#define cycle_counter_elapsed(start) (DWT->CYCCNT - (start))
+/* one division per call, timebase.h converts with precomputed multipliers */
 #define cycles_per_us (SystemCoreClock / 1000000)
 #define cycle_counter_time_us() (DWT->CYCCNT / cycles_per_us)
 
@@ -0,0 +1,62 @@
+/*
+ * flash_eeprom.h
+ *
+ */
+
+#ifndef INC_FLASH_EEPROM_H_
+#define INC_FLASH_EEPROM_H_
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "task_shared_params.h"
+
+/********************** macros ***********************************************/
+
+/* Flash pages used in rotation, must match the EEPROM region of the linker
+ * script (_flash_eeprom_start/_flash_eeprom_end) */
+#define FLASH_EEPROM_PAGE_QTY		2ul
+
+/********************** typedef **********************************************/
+
+/* Append-only record, programmed as one double word (4 half-words) */
+typedef struct
+{
+	uint16_t	magic;
+	uint8_t		lane;
+	uint8_t		pack_rate;
+	uint8_t		waiting_time;
+	uint8_t		reserved;
+	uint16_t	crc;
+} flash_eeprom_record_t;
+
+/* Page header, takes the first record slot of every page */
+typedef struct
+{
+	uint16_t	state;
+	uint16_t	generation;
+	uint32_t	reserved;
+} flash_eeprom_header_t;
+
+/********************** external data declaration ****************************/
+
+/********************** external functions declaration ***********************/
+extern bool flash_eeprom_init(void);
+extern bool flash_eeprom_read(uint32_t lane, task_shared_params_dta_t *p_dta);
+extern bool flash_eeprom_write(uint32_t lane, const task_shared_params_dta_t *p_dta);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_FLASH_EEPROM_H_ */
+
+/********************** end of file ******************************************/
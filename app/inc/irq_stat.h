@@ -0,0 +1,77 @@
+/*
+ * irq_stat.h
+ *
+ */
+
+#ifndef INC_IRQ_STAT_H_
+#define INC_IRQ_STAT_H_
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "main.h"
+
+/********************** macros ***********************************************/
+
+#define IRQ_STAT_CONFIG_ENABLE		(1)
+
+/* log2 buckets of cycles: 0, 1, 2-3, 4-7, ... the last one takes the rest */
+#define IRQ_STAT_HIST_QTY			16ul
+
+#if 1 == IRQ_STAT_CONFIG_ENABLE
+/* First statement of SysTick_Handler: the exception is raised as the
+ * counter reaches 0 and it reloads LOAD one cycle later, so (LOAD + 1) - VAL
+ * is the entry latency in HCLK cycles */
+#define IRQ_STAT_SYSTICK_LATENCY()	irq_stat_record(IRQ_STAT_SRC_SYSTICK, (SysTick->LOAD + 1ul) - SysTick->VAL)
+
+/* Right after CPSID i and right before CPSIE i, thread mode only */
+#define IRQ_STAT_CS_BEGIN()			(irq_stat_cs_start = DWT->CYCCNT)
+#define IRQ_STAT_CS_END(src)		irq_stat_record((src), DWT->CYCCNT - irq_stat_cs_start)
+#else
+#define IRQ_STAT_SYSTICK_LATENCY()
+#define IRQ_STAT_CS_BEGIN()
+#define IRQ_STAT_CS_END(src)
+#endif
+
+/********************** typedef **********************************************/
+
+/* Names in irq_stat.c */
+typedef enum irq_stat_src {IRQ_STAT_SRC_SYSTICK,		// Entry latency
+						   IRQ_STAT_SRC_CS_SENSOR,		// Critical sections of each task
+						   IRQ_STAT_SRC_CS_COMMAND,
+						   IRQ_STAT_SRC_CS_NORMAL,
+						   IRQ_STAT_SRC_CS_SETUP,
+						   IRQ_STAT_SRC_CS_ACTUATOR,
+						   IRQ_STAT_SRC_QTY} irq_stat_src_t;
+
+typedef struct
+{
+	uint32_t	cnt;
+	uint32_t	max;						// Worst case, cycles
+	uint32_t	hist[IRQ_STAT_HIST_QTY];
+} irq_stat_t;
+
+/********************** external data declaration ****************************/
+extern irq_stat_t irq_stat_list[IRQ_STAT_SRC_QTY];
+extern uint32_t irq_stat_cs_start;
+
+/********************** external functions declaration ***********************/
+extern void irq_stat_reset(void);
+extern void irq_stat_record(irq_stat_src_t src, uint32_t cycles);
+extern bool irq_stat_dump(uint32_t *p_cursor);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_IRQ_STAT_H_ */
+
+/********************** end of file ******************************************/
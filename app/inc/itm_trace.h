@@ -0,0 +1,54 @@
+/*
+ * itm_trace.h
+ *
+ */
+
+#ifndef INC_ITM_TRACE_H_
+#define INC_ITM_TRACE_H_
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+
+#define ITM_TRACE_CONFIG_ENABLE		(1)
+
+/* Stimulus ports, tools/swo_timeline.py decodes the same numbers */
+#define ITM_TRACE_PORT_LOG			0ul		// Logger bytes
+#define ITM_TRACE_PORT_TASK_START	1ul		// Task index, 1 byte
+#define ITM_TRACE_PORT_TASK_STOP	2ul		// Task index, 1 byte
+#define ITM_TRACE_PORT_LOG_ISR		3ul		// Logger bytes from handler mode
+
+#if 1 == ITM_TRACE_CONFIG_ENABLE
+#define ITM_TRACE_TASK_START(index)	itm_trace_marker(ITM_TRACE_PORT_TASK_START, (index))
+#define ITM_TRACE_TASK_STOP(index)	itm_trace_marker(ITM_TRACE_PORT_TASK_STOP, (index))
+#else
+#define ITM_TRACE_TASK_START(index)
+#define ITM_TRACE_TASK_STOP(index)
+#endif
+
+/********************** typedef **********************************************/
+
+/********************** external data declaration ****************************/
+extern volatile uint32_t itm_trace_drop_cnt;
+
+/********************** external functions declaration ***********************/
+extern void itm_trace_init(void);
+extern void itm_trace_write(uint32_t port, const void *p_data, uint32_t len);
+extern void itm_trace_marker(uint32_t port, uint32_t value);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_ITM_TRACE_H_ */
+
+/********************** end of file ******************************************/
@@ -0,0 +1,51 @@
+/*
+ * led_timer.h
+ *
+ */
+
+#ifndef INC_LED_TIMER_H_
+#define INC_LED_TIMER_H_
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "main.h"
+
+/********************** macros ***********************************************/
+
+/* Counter clock of the LED timers, periods are programmed in ms */
+#define LED_TIMER_CNT_FREQ_HZ	10000ul
+#define LED_TIMER_CNT_PER_MS	(LED_TIMER_CNT_FREQ_HZ / 1000ul)
+
+/* One LED per timer: the channel given to led_timer_init() owns the whole
+ * counter, a second channel of the same timer is refused */
+
+/* Longest blink half period or pulse (16 bit auto-reload) */
+#define LED_TIMER_MAX_MS		(0xFFFFul / LED_TIMER_CNT_PER_MS)
+
+/********************** typedef **********************************************/
+
+/********************** external data declaration ****************************/
+
+/********************** external functions declaration ***********************/
+extern bool led_timer_init(TIM_TypeDef *tim, uint32_t channel, GPIO_TypeDef *gpio_port, uint16_t pin, bool active_high);
+extern void led_timer_force(TIM_TypeDef *tim, uint32_t channel, bool active);
+extern void led_timer_blink(TIM_TypeDef *tim, uint32_t channel, uint32_t half_period_ms);
+extern void led_timer_pulse(TIM_TypeDef *tim, uint32_t channel, uint32_t width_ms);
+extern bool led_timer_busy(TIM_TypeDef *tim);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_LED_TIMER_H_ */
+
+/********************** end of file ******************************************/
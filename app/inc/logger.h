@@ -51,32 +51,186 @@ extern "C" {
 
 /********************** macros ***********************************************/
 
+#define LOGGER_BACKEND_SEMIHOSTING              (0)
+#define LOGGER_BACKEND_UART                     (1)
+#define LOGGER_BACKEND_ITM                      (2)
+
+#define LOGGER_LEVEL_NONE                       (0)
+#define LOGGER_LEVEL_ERROR                      (1)
+#define LOGGER_LEVEL_WARN                       (2)
+#define LOGGER_LEVEL_INFO                       (3)
+#define LOGGER_LEVEL_DEBUG                      (4)
+#define LOGGER_LEVEL_TRACE                      (5)
+
 #define LOGGER_CONFIG_ENABLE                    (1)
 #define LOGGER_CONFIG_MAXLEN                    (64)
-#define LOGGER_CONFIG_USE_SEMIHOSTING           (1)
+#define LOGGER_CONFIG_BACKEND                   LOGGER_BACKEND_UART
+
+/* UART backend: bytes waiting for USART2 TX DMA, must be a power of two */
+#define LOGGER_CONFIG_RING_SIZE                 (1024)
+
+/* UART & ITM backends: LOGGER_LOGD sends binary records, decoded on the
+ * host by tools/logger_decode.py from the ELF */
+#define LOGGER_CONFIG_DEFERRED                  (1)
+#define LOGGER_CONFIG_DEFERRED_MAX_ARGS         (8)
+
+/* Compile-time thresholds: calls above the threshold of their module are
+ * stripped. A module selects its threshold defining LOGGER_MODULE_LEVEL
+ * before including this file, e.g. LOGGER_LEVEL_ERROR for production */
+#define LOGGER_CONFIG_LEVEL                     LOGGER_LEVEL_INFO
+#define LOGGER_CONFIG_LEVEL_TASK_NORMAL         LOGGER_CONFIG_LEVEL
+#define LOGGER_CONFIG_LEVEL_TASK_SETUP          LOGGER_CONFIG_LEVEL
 
+/* Runtime threshold of the calls left in, see logger_set_level() */
+#define LOGGER_CONFIG_LEVEL_RUNTIME             LOGGER_LEVEL_TRACE
+
+/* Limited logs: identical consecutive messages of a call site are counted,
+ * and the count is reported when the message changes or once per period.
+ * logger_update() reports it too once a period has gone by since the last
+ * message or summary (this long for the sites without a period), so the
+ * count of a site gone quiet is not held back */
+#define LOGGER_CONFIG_REPEAT_PERIOD_MS          (5000)
+
+/* Binary record: sync, argument count, message id (LE), arguments (LE).
+ * The sync byte is not ASCII, so records and text share the stream */
+#define LOGGER_DEFERRED_SYNC                    (0xA5)
+#define LOGGER_DEFERRED_HEADER_LEN              (4)
+
+/* Repeat summary, arguments: message id, count. Matched by the decoder */
+#define LOGGER_DEFERRED_REPEAT_FMT              "  last message repeated %lu times (id %lu)\n"
+
+/* Formats on the caller stack, interrupts are never masked. The UART and
+ * ITM backends can be used from interrupt handlers */
 #if 1 == LOGGER_CONFIG_ENABLE
 #define LOGGER_LOG(...)\
-	__asm("CPSID i");	/* disable interrupts*/\
     {\
-        logger_msg_len = snprintf(logger_msg, (LOGGER_CONFIG_MAXLEN - 1), __VA_ARGS__);\
-        logger_log_print_(logger_msg);\
-    }\
-	__asm("CPSIE i");	/* enable interrupts*/
+        char logger_msg_[LOGGER_CONFIG_MAXLEN];\
+        int logger_len_ = snprintf(logger_msg_, LOGGER_CONFIG_MAXLEN, __VA_ARGS__);\
+        logger_msg_len = logger_len_;\
+        logger_log_print_(logger_msg_, logger_len_);\
+    }
 #else
 #define LOGGER_LOG(...)
 #endif
 
+/* Deferred log: only integer arguments (no %s, no floats). The format stays
+ * in the .logger_fmt section, its offset there is sent as the message id */
+#if (1 == LOGGER_CONFIG_ENABLE) && (1 == LOGGER_CONFIG_DEFERRED) && (LOGGER_BACKEND_SEMIHOSTING != LOGGER_CONFIG_BACKEND)
+#define LOGGER_LOGD(fmt, ...)\
+    {\
+        static const char logger_fmt_[] __attribute__((section(".logger_fmt"), used)) = fmt;\
+        const uint32_t logger_arg_[] = {0, ##__VA_ARGS__};\
+        logger_logd_((uint32_t)(uintptr_t)logger_fmt_, &logger_arg_[1], (sizeof(logger_arg_) / sizeof(uint32_t)) - 1);\
+    }
+#else
+#define LOGGER_LOGD(...) LOGGER_LOG(__VA_ARGS__)
+#endif
+
+/* Deferred log with per call site repeat suppression, period in ms (0 only
+ * reports the count when the message changes) */
+#if (1 == LOGGER_CONFIG_ENABLE) && (1 == LOGGER_CONFIG_DEFERRED) && (LOGGER_BACKEND_SEMIHOSTING != LOGGER_CONFIG_BACKEND)
+#define LOGGER_LOGD_LIMIT(period, fmt, ...)\
+    {\
+        static logger_site_t logger_site_;\
+        static const char logger_fmt_[] __attribute__((section(".logger_fmt"), used)) = fmt;\
+        const uint32_t logger_arg_[] = {0, ##__VA_ARGS__};\
+        logger_logd_limit_(&logger_site_, (uint32_t)(uintptr_t)logger_fmt_, (period), &logger_arg_[1], (sizeof(logger_arg_) / sizeof(uint32_t)) - 1);\
+    }
+#else
+#define LOGGER_LOGD_LIMIT(period, ...) LOGGER_LOG(__VA_ARGS__)
+#endif
+
+/* Leveled logs (deferred when available, so integer arguments only) */
+#ifndef LOGGER_MODULE_LEVEL
+#define LOGGER_MODULE_LEVEL                     LOGGER_CONFIG_LEVEL
+#endif
+
+#define LOGGER_LOG_LEVEL_(level, ...)\
+    {\
+        if ((uint32_t)(level) <= logger_level)\
+        {\
+            LOGGER_LOGD(__VA_ARGS__)\
+        }\
+    }
+
+#define LOGGER_LOG_LEVEL_LIMIT_(level, period, ...)\
+    {\
+        if ((uint32_t)(level) <= logger_level)\
+        {\
+            LOGGER_LOGD_LIMIT(period, __VA_ARGS__)\
+        }\
+    }
+
+#if LOGGER_LEVEL_ERROR <= LOGGER_MODULE_LEVEL
+#define LOGGER_ERROR(...)   LOGGER_LOG_LEVEL_(LOGGER_LEVEL_ERROR, __VA_ARGS__)
+#define LOGGER_ERROR_LIMIT(period, ...)   LOGGER_LOG_LEVEL_LIMIT_(LOGGER_LEVEL_ERROR, period, __VA_ARGS__)
+#else
+#define LOGGER_ERROR(...)
+#define LOGGER_ERROR_LIMIT(period, ...)
+#endif
+
+#if LOGGER_LEVEL_WARN <= LOGGER_MODULE_LEVEL
+#define LOGGER_WARN(...)    LOGGER_LOG_LEVEL_(LOGGER_LEVEL_WARN, __VA_ARGS__)
+#define LOGGER_WARN_LIMIT(period, ...)    LOGGER_LOG_LEVEL_LIMIT_(LOGGER_LEVEL_WARN, period, __VA_ARGS__)
+#else
+#define LOGGER_WARN(...)
+#define LOGGER_WARN_LIMIT(period, ...)
+#endif
+
+#if LOGGER_LEVEL_INFO <= LOGGER_MODULE_LEVEL
+#define LOGGER_INFO(...)    LOGGER_LOG_LEVEL_(LOGGER_LEVEL_INFO, __VA_ARGS__)
+#define LOGGER_INFO_LIMIT(period, ...)    LOGGER_LOG_LEVEL_LIMIT_(LOGGER_LEVEL_INFO, period, __VA_ARGS__)
+#else
+#define LOGGER_INFO(...)
+#define LOGGER_INFO_LIMIT(period, ...)
+#endif
+
+#if LOGGER_LEVEL_DEBUG <= LOGGER_MODULE_LEVEL
+#define LOGGER_DEBUG(...)   LOGGER_LOG_LEVEL_(LOGGER_LEVEL_DEBUG, __VA_ARGS__)
+#define LOGGER_DEBUG_LIMIT(period, ...)   LOGGER_LOG_LEVEL_LIMIT_(LOGGER_LEVEL_DEBUG, period, __VA_ARGS__)
+#else
+#define LOGGER_DEBUG(...)
+#define LOGGER_DEBUG_LIMIT(period, ...)
+#endif
+
+#if LOGGER_LEVEL_TRACE <= LOGGER_MODULE_LEVEL
+#define LOGGER_TRACE(...)   LOGGER_LOG_LEVEL_(LOGGER_LEVEL_TRACE, __VA_ARGS__)
+#define LOGGER_TRACE_LIMIT(period, ...)   LOGGER_LOG_LEVEL_LIMIT_(LOGGER_LEVEL_TRACE, period, __VA_ARGS__)
+#else
+#define LOGGER_TRACE(...)
+#define LOGGER_TRACE_LIMIT(period, ...)
+#endif
+
 #define GET_NAME(var)  #var
 
 /********************** typedef **********************************************/
 
-extern char* const logger_msg;
+/* Per call site state of LOGGER_LOGD_LIMIT */
+typedef struct logger_site
+{
+    struct logger_site* next;   // Sites already sent from, see logger_update()
+    bool     sent;      // A message was sent from this site
+    uint32_t id;        // Message id of the last message sent
+    uint32_t hash;      // Arguments of the last message sent
+    uint32_t repeat;    // Identical messages suppressed since
+    uint32_t period;    // Summary period of the last message sent, in ms
+    uint32_t time;      // HAL tick of the last message or summary sent
+} logger_site_t;
+
 extern int logger_msg_len; // only for debug information
+extern volatile uint32_t logger_drop_cnt; // messages lost with the ring full
+extern volatile uint32_t logger_level; // runtime threshold of the leveled logs
 
 /********************** external functions declaration ***********************/
 
-void logger_log_print_(char* const msg);
+void logger_log_print_(const char* msg, int len);
+bool logger_write(const char* data, uint32_t len);
+bool logger_uart_write(const char* data, uint32_t len);
+uint32_t logger_uart_room(void);
+void logger_logd_(uint32_t id, const uint32_t* args, uint32_t qty);
+void logger_logd_limit_(logger_site_t* site, uint32_t id, uint32_t period, const uint32_t* args, uint32_t qty);
+void logger_update(void);
+void logger_set_level(uint32_t level);
 
 /********************** End of CPP guard *************************************/
 #ifdef __cplusplus
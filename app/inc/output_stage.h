@@ -0,0 +1,42 @@
+/*
+ * output_stage.h
+ *
+ */
+
+#ifndef INC_OUTPUT_STAGE_H_
+#define INC_OUTPUT_STAGE_H_
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "main.h"
+
+/********************** macros ***********************************************/
+
+/* GPIOA..GPIOE, consecutive 0x400 apart on APB2 */
+#define OUTPUT_STAGE_PORT_QTY	5ul
+
+/********************** typedef **********************************************/
+
+/********************** external data declaration ****************************/
+
+/********************** external functions declaration ***********************/
+extern void output_stage_init(void);
+extern void output_stage_write(GPIO_TypeDef *gpio_port, uint16_t pin, GPIO_PinState state);
+extern void output_stage_flush(void);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_OUTPUT_STAGE_H_ */
+
+/********************** end of file ******************************************/
@@ -0,0 +1,79 @@
+/*
+ * profile.h
+ *
+ */
+
+#ifndef INC_PROFILE_H_
+#define INC_PROFILE_H_
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "main.h"
+
+/********************** macros ***********************************************/
+
+#define PROFILE_CONFIG_ENABLE		(1)
+
+/* Zones read the free running CYCCNT, which is never reset once started.
+ * Begin and end of a zone must run in the same context, zones may nest but
+ * a zone may not be re-entered before its end */
+#if 1 == PROFILE_CONFIG_ENABLE
+#define PROFILE_ZONE_BEGIN(zone)	(profile_zone_dta_list[(zone)].start = DWT->CYCCNT)
+#define PROFILE_ZONE_END(zone)		profile_zone_end((zone), DWT->CYCCNT)
+#else
+#define PROFILE_ZONE_BEGIN(zone)
+#define PROFILE_ZONE_END(zone)
+#endif
+
+/********************** typedef **********************************************/
+
+/* Registry of zones, names in profile.c */
+typedef enum profile_zone {PROFILE_ZONE_TASK_SENSOR,		// One per task_cfg_list entry, same order
+						   PROFILE_ZONE_TASK_COMMAND,
+						   PROFILE_ZONE_TASK_NORMAL,
+						   PROFILE_ZONE_TASK_SETUP,
+						   PROFILE_ZONE_TASK_ACTUATOR,
+						   PROFILE_ZONE_CMD_PARSE,
+						   PROFILE_ZONE_CMD_EXECUTE,
+						   PROFILE_ZONE_NML_LANE,
+						   PROFILE_ZONE_NML_PLAN,
+						   PROFILE_ZONE_SETUP_FSM,
+						   PROFILE_ZONE_ACT_BAR,
+						   PROFILE_ZONE_ACT_LED,
+						   PROFILE_ZONE_ACT_FLUSH,
+						   PROFILE_ZONE_QTY} profile_zone_t;
+
+typedef struct
+{
+	uint32_t	start;		// CYCCNT at the last begin
+	uint32_t	cnt;		// Completed runs
+	uint64_t	total;		// Cycles of every run
+	uint32_t	min;
+	uint32_t	max;
+} profile_zone_dta_t;
+
+/********************** external data declaration ****************************/
+extern profile_zone_dta_t profile_zone_dta_list[PROFILE_ZONE_QTY];
+
+/********************** external functions declaration ***********************/
+extern void profile_init(void);
+extern void profile_zone_end(profile_zone_t zone, uint32_t cycle_counter);
+extern void profile_reset(void);
+extern bool profile_dump(uint32_t *p_cursor);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_PROFILE_H_ */
+
+/********************** end of file ******************************************/
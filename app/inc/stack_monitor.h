@@ -0,0 +1,48 @@
+/*
+ * stack_monitor.h
+ *
+ */
+
+#ifndef INC_STACK_MONITOR_H_
+#define INC_STACK_MONITOR_H_
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+
+/* Written by Reset_Handler (startup_stm32f103rbtx.s) from _end up to the
+ * initial stack pointer, keep both in sync */
+#define STACK_MONITOR_PAINT			0xDEADBEEFul
+
+/* Bytes above the bottom of the reserved stack (_estack - _Min_Stack_Size)
+ * where the guard word sits, the margin left when it trips */
+#define STACK_MONITOR_GUARD			64ul
+
+/********************** typedef **********************************************/
+
+/********************** external data declaration ****************************/
+extern volatile uint32_t stack_monitor_trip_cnt;
+
+/********************** external functions declaration ***********************/
+extern void stack_monitor_init(void);
+extern bool stack_monitor_check(void);
+extern void stack_monitor_trip(void);
+extern uint32_t stack_monitor_used(void);
+extern uint32_t stack_monitor_size(void);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_STACK_MONITOR_H_ */
+
+/********************** end of file ******************************************/
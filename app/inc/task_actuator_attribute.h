@@ -45,6 +45,8 @@ extern "C" {
 
 /********************** inclusions *******************************************/
 
+#include <task_shared_params.h>
+
 /********************** macros ***********************************************/
 
 /********************** typedef **********************************************/
@@ -118,8 +120,25 @@ typedef enum task_actuator_st {ST_LED_XX_OFF,
 							   ST_LED_XX_BLINK_OFF,
 							   ST_LED_XX_PULSE} task_actuator_st_t;
 
-/* Identifier of Task Actuator */
-typedef enum task_actuator_id {ID_LED_A} task_actuator_id_t;
+/* Identifier of Task Actuator, bar segments are consecutive from the
+ * lowest one */
+typedef enum task_actuator_id {ID_LED_A,
+							   ID_LED_PACKS_0,
+							   ID_LED_PACKS_1,
+							   ID_LED_PACKS_2,
+							   ID_LED_PACKS_3,
+							   ID_LED_SPEED_0,
+							   ID_LED_SPEED_1,
+							   ID_LED_SPEED_2,
+							   ID_LED_SPEED_3} task_actuator_id_t;
+
+/* Values a bar graph can display */
+typedef enum task_actuator_bar_src {BAR_SRC_QTY_PACKS,
+									BAR_SRC_SPEED} task_actuator_bar_src_t;
+
+/* Identifier of the Task Actuator bar graphs */
+typedef enum task_actuator_bar_id {ID_BAR_PACKS,
+								   ID_BAR_SPEED} task_actuator_bar_id_t;
 
 typedef struct
 {
@@ -130,6 +149,8 @@ typedef struct
 	GPIO_PinState		led_off;
 	uint32_t			tick_blink;
 	uint32_t			tick_pulse;
+	TIM_TypeDef *		tim;			// Timer driving the pin, NULL for software blink & pulse
+	uint32_t			tim_channel;	// Output compare channel (1..4)
 } task_actuator_cfg_t;
 
 typedef struct
@@ -138,11 +159,35 @@ typedef struct
 	task_actuator_st_t	state;
 	task_actuator_ev_t	event;
 	bool				flag;
+	TIM_TypeDef *		tim;			// cfg tim once led_timer_init() took it, NULL otherwise
 } task_actuator_dta_t;
 
+/* Bar graph over segment_qty actuators: value / full_scale lights the
+ * segments from first_segment up */
+typedef struct
+{
+	task_actuator_bar_id_t	identifier;
+	task_actuator_bar_src_t	source;
+	uint32_t				lane;
+	task_actuator_id_t		first_segment;
+	uint32_t				segment_qty;
+	uint32_t				full_scale;
+} task_actuator_bar_cfg_t;
+
+typedef struct
+{
+	uint32_t			value;
+	uint32_t			level;		// Segments lit
+	bool				flag;		// value changed since the segments were updated
+} task_actuator_bar_dta_t;
+
 /********************** external data declaration ****************************/
 extern task_actuator_dta_t task_actuator_dta_list[];
 
+extern const task_actuator_bar_cfg_t task_actuator_bar_cfg_list[];
+extern task_actuator_bar_dta_t task_actuator_bar_dta_list[];
+extern const uint32_t task_actuator_bar_qty;
+
 /********************** external functions declaration ***********************/
 
 /********************** End of CPP guard *************************************/
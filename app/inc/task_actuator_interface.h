@@ -53,6 +53,7 @@ extern "C" {
 
 /********************** external functions declaration ***********************/
 extern void put_event_task_actuator(task_actuator_ev_t event, task_actuator_id_t identifier);
+extern void put_value_task_actuator_bar(task_actuator_bar_src_t source, uint32_t lane, uint32_t value);
 
 /********************** End of CPP guard *************************************/
 #ifdef __cplusplus
@@ -0,0 +1,35 @@
+/*
+ * task_command.h
+ *
+ */
+
+#ifndef TASK_INC_TASK_COMMAND_H_
+#define TASK_INC_TASK_COMMAND_H_
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+
+/********************** macros ***********************************************/
+
+/********************** typedef **********************************************/
+
+/********************** external data declaration ****************************/
+extern uint32_t g_task_command_cnt;
+extern volatile uint32_t g_task_command_tick_cnt;
+
+/********************** external functions declaration ***********************/
+void task_command_init(void *parameters);
+void task_command_update(void *parameters);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TASK_INC_TASK_COMMAND_H_ */
+
+/********************** end of file ******************************************/
@@ -0,0 +1,98 @@
+/*
+ * task_command_attribute.h
+ *
+ */
+
+#ifndef TASK_INC_TASK_COMMAND_ATTRIBUTE_H_
+#define TASK_INC_TASK_COMMAND_ATTRIBUTE_H_
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+
+/* USART2 RX DMA ring, must be a power of two */
+#define CMD_RX_BUFFER_SIZE		64ul
+#define CMD_RX_BUFFER_MASK		(CMD_RX_BUFFER_SIZE - 1ul)
+
+/* Tokens kept per command line */
+#define CMD_TOKEN_QTY			4ul
+
+/********************** typedef **********************************************/
+/* Command Line Grammar (one command per line, ended by '\r' or '\n')
+ *
+ * 	get pack_rate|waiting_time|counters|log_level|profile|irq|stack|heap [lane]
+ * 	set pack_rate|waiting_time <value> [lane]
+ * 	set log_level <level>
+ * 	set profile|irq 0
+ * 	set trace 0|1
+ * 	key enter|next|escape [lane]
+ *
+ * Replies: "ok", "ok <value>", "counters <lane> <app cnt> <packs> <speed>",
+ * "stack <high-water bytes> <reserved bytes> <guard trips>",
+ * "heap <sbrk bytes> <sbrk peak> <allocs> <allocs after init>" after one
+ * "heap_site <address> <allocs> <bytes>" per call site, or "err". A key
+ * is "err" for another lane while a setup menu is open, or with the setup
+ * queue full. "get profile|irq" log a line per tick as the USART2 ring has
+ * room, then "ok"; lines sent meanwhile wait (CMD_RX_BUFFER_SIZE bytes)
+ */
+
+/* Keywords, the value is the bit of the keyword in the candidate mask */
+typedef enum task_command_kw {KW_CMD_GET,
+							  KW_CMD_SET,
+							  KW_CMD_KEY,
+							  KW_CMD_PACK_RATE,
+							  KW_CMD_WAITING_TIME,
+							  KW_CMD_COUNTERS,
+							  KW_CMD_ENTER,
+							  KW_CMD_NEXT,
+							  KW_CMD_ESCAPE,
+							  KW_CMD_LOG_LEVEL,
+							  KW_CMD_PROFILE,
+							  KW_CMD_TRACE,
+							  KW_CMD_IRQ,
+							  KW_CMD_STACK,
+							  KW_CMD_HEAP,
+							  KW_CMD_QTY,
+							  KW_CMD_NUMBER = KW_CMD_QTY,
+							  KW_CMD_UNKNOWN} task_command_kw_t;
+
+/* State of the line parser */
+typedef enum task_command_st {ST_CMD_SPACE,
+							  ST_CMD_WORD,
+							  ST_CMD_NUMBER,
+							  ST_CMD_DISCARD} task_command_st_t;
+
+typedef struct
+{
+	uint32_t			tail;					// Next ring index to parse
+	uint32_t			length;					// Length of the current token
+	uint32_t			candidates;				// Keywords still matching the current token
+	uint32_t			token_qty;
+	task_command_kw_t	token[CMD_TOKEN_QTY];
+	uint32_t			value[CMD_TOKEN_QTY];	// Value of the KW_CMD_NUMBER tokens
+	task_command_st_t	state;
+	task_command_kw_t	dump;					// Dump in progress (profile, irq), KW_CMD_UNKNOWN if none
+	uint32_t			dump_cursor;			// Next line of that dump
+} task_command_dta_t;
+
+/********************** external data declaration ****************************/
+extern task_command_dta_t task_command_dta;
+
+/********************** external functions declaration ***********************/
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TASK_INC_TASK_COMMAND_ATTRIBUTE_H_ */
+
+/********************** end of file ******************************************/
@@ -50,6 +50,10 @@ extern "C" {
 
 /********************** macros ***********************************************/
 
+/* Speed range of a lane under control, also the full scale of its bar */
+#define DEL_NML_MIN_SPEED			1ul
+#define DEL_NML_MAX_SPEED			20ul
+
 /********************** typedef **********************************************/
 /* System Statechart - State Transition Table */
 /* 	------------------------+-----------------------+-----------------------+-----------------------+------------------------
@@ -74,22 +78,30 @@ typedef enum task_normal_ev {EV_NML_IDLE,
 							 EV_NML_NO_PACK_OUT,
 							 EV_NML_PACKS,
 							 EV_NML_NO_PACKS,
-							 EV_NML_SETUP_ON,
-							 EV_NML_SETUP_OFF} task_normal_ev_t;
+							 EV_NML_SETUP_ON,			// Answers of Task Setup
+							 EV_NML_SETUP_OFF,
+							 EV_NML_SETUP_SW_ON,		// Setup switch of the lane
+							 EV_NML_SETUP_SW_OFF} task_normal_ev_t;
 
 /* State of Task System */
 typedef enum task_normal_st {ST_NML_IDLE,
 							 ST_NML_SYST_CTRL,
 							 ST_NML_SETUP} task_normal_st_t;
 
+/* Structure of arrays: one entry per lane, so a tick walks each field
+ * contiguously for all lanes */
 typedef struct
 {
-	uint32_t			tick;
-	uint32_t			speed;
-	uint32_t			qty_packs;
-	task_normal_st_t	state;
-	task_normal_ev_t	event;
-	bool				flag;
+	uint32_t			tick[SYST_LANE_QTY];
+	uint32_t			speed[SYST_LANE_QTY];
+	uint32_t			qty_packs[SYST_LANE_QTY];
+	uint32_t			pack_rate[SYST_LANE_QTY];		// pack_rate the mask below was built for
+	uint32_t			speed_step_mask[SYST_LANE_QTY];	// bit qty set <=> (qty % pack_rate) == 0
+	uint32_t			target_speed[SYST_LANE_QTY];	// Speed chosen by the planner
+	int32_t				flow_trend[SYST_LANE_QTY];		// Net packs in per pack event (Q8 EWMA)
+	task_normal_st_t	state[SYST_LANE_QTY];
+	task_normal_ev_t	event[SYST_LANE_QTY];
+	bool				flag[SYST_LANE_QTY];
 } task_normal_dta_t;
 
 /********************** external data declaration ****************************/
@@ -45,6 +45,7 @@ extern "C" {
 
 /********************** inclusions *******************************************/
 
+#include <stdint.h>
 #include <stdbool.h>
 
 /********************** macros ***********************************************/
@@ -55,9 +56,9 @@ extern "C" {
 
 /********************** external functions declaration ***********************/
 extern void init_queue_event_task_normal(void);
-extern void put_event_task_normal(task_normal_ev_t event);
-extern task_normal_ev_t get_event_task_normal(void);
-extern bool any_event_task_normal(void);
+extern void put_event_task_normal(task_normal_ev_t event, uint32_t lane);
+extern task_normal_ev_t get_event_task_normal(uint32_t lane);
+extern bool any_event_task_normal(uint32_t lane);
 
 /********************** End of CPP guard *************************************/
 #ifdef __cplusplus
@@ -101,6 +101,10 @@ typedef enum task_sensor_id {ID_BTN_PACK_IN,
 							 ID_BTN_NEXT,
 							 ID_BTN_ESCAPE} task_sensor_id_t;
 
+/* Task whose queue takes the signals of a sensor */
+typedef enum task_sensor_dst {DST_TASK_NORMAL,
+							  DST_TASK_SETUP} task_sensor_dst_t;
+
 typedef struct
 {
 	task_sensor_id_t	identifier;
@@ -110,6 +114,8 @@ typedef struct
 	uint32_t			tick_max;
 	task_sensor_ev_t	signal_up;
 	task_sensor_ev_t	signal_down;
+	uint32_t			lane;
+	task_sensor_dst_t	destination;
 } task_sensor_cfg_t;
 
 typedef struct
@@ -70,7 +70,8 @@ typedef enum task_setup_ev {EV_SETUP_IDLE,
 							EV_SETUP_OFF,
 							EV_SETUP_ENTER,
 							EV_SETUP_ESCAPE,
-							EV_SETUP_NEXT} task_setup_ev_t;
+							EV_SETUP_NEXT,
+							EV_SETUP_LANE} task_setup_ev_t;
 
 /* State of Task System */
 typedef enum task_setup_st {ST_SETUP_NORMAL,
@@ -84,6 +85,7 @@ typedef struct
 	task_setup_st_t		state;
 	task_setup_ev_t		event;
 	bool				flag;
+	uint32_t			lane;		// Lane whose shared params are being set up
 } task_setup_dta_t;
 
 /********************** external data declaration ****************************/
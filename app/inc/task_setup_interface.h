@@ -45,6 +45,7 @@ extern "C" {
 
 /********************** inclusions *******************************************/
 
+#include <stdint.h>
 #include <stdbool.h>
 
 /********************** macros ***********************************************/
@@ -56,8 +57,11 @@ extern "C" {
 /********************** external functions declaration ***********************/
 extern void init_queue_event_task_setup(void);
 extern void put_event_task_setup(task_setup_ev_t event);
-extern task_setup_ev_t get_event_task_setup(void);
+extern void put_lane_event_task_setup(task_setup_ev_t event, uint32_t lane);
+extern task_setup_ev_t get_event_task_setup(uint32_t *p_lane);
 extern bool any_event_task_setup(void);
+extern uint32_t free_event_task_setup(void);
+extern void put_lane_task_setup(uint32_t lane);
 
 /********************** End of CPP guard *************************************/
 #ifdef __cplusplus
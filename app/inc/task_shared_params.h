@@ -9,6 +9,7 @@
 #define INC_TASK_SHARED_PARAMS_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /********************** macros and definitions *******************************/
 #define DEL_SYST_MIN	 			0ul
@@ -18,6 +19,14 @@
 #define DEL_SYST_MAX_PACKS			10ul
 #define DEL_SYST_MAX_WAITING_TIME	30ul
 
+/* Lanes (belts) driven by this controller, each one with its own sensors,
+ * shared params and Task Normal queue. The host build overrides the count
+ * to measure the per-tick cost against it (make -C sim lanes) */
+#define SYST_LANE_0					0ul
+#ifndef SYST_LANE_QTY
+#define SYST_LANE_QTY				1ul
+#endif
+
 /********************** typedef **********************************************/
 
 typedef struct
@@ -26,7 +35,21 @@ typedef struct
 	uint32_t		waiting_time;
 } task_shared_params_dta_t;
 
+/* Versioned double buffer: writers fill the inactive buffer and publish it by
+ * bumping version; readers copy the active buffer and retry if version moved */
+typedef struct
+{
+	volatile uint32_t			version;
+	volatile uint32_t			lock;
+	task_shared_params_dta_t	buffer[2];
+} task_shared_params_t;
+
 /********************** external data declaration ****************************/
 extern task_shared_params_dta_t task_shared_params_dta;
 
+/********************** external functions declaration ***********************/
+extern void init_task_shared_params(task_shared_params_t *p_params, const task_shared_params_dta_t *p_dta);
+extern bool publish_task_shared_params(task_shared_params_t *p_params, const task_shared_params_dta_t *p_dta);
+extern void snapshot_task_shared_params(task_shared_params_t *p_params, task_shared_params_dta_t *p_dta);
+
 #endif /* INC_TASK_SHARED_PARAMS_H_ */
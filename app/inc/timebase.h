@@ -0,0 +1,54 @@
+/*
+ * timebase.h
+ *
+ */
+
+#ifndef INC_TIMEBASE_H_
+#define INC_TIMEBASE_H_
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "main.h"
+
+/********************** macros ***********************************************/
+
+/* Fixed point of the conversion multipliers */
+#define TIMEBASE_NS_SHIFT		16ul
+#define TIMEBASE_US_SHIFT		32ul
+
+/* Durations below one CYCCNT wrap (32 bit cycles), one multiply and one
+ * shift instead of a division */
+#define timebase_delta_to_us(cycles)	((uint32_t)(((uint64_t)(cycles) * timebase_mult_us) >> TIMEBASE_US_SHIFT))
+#define timebase_delta_to_ns(cycles)	(((uint64_t)(cycles) * timebase_mult_ns) >> TIMEBASE_NS_SHIFT)
+
+/********************** typedef **********************************************/
+
+/********************** external data declaration ****************************/
+extern uint32_t timebase_mult_ns;	// ns per cycle, Q16
+extern uint32_t timebase_mult_us;	// us per cycle, Q32
+
+/********************** external functions declaration ***********************/
+extern void timebase_init(void);
+extern void timebase_update(void);
+extern uint64_t timebase_get_cycles(void);
+extern uint64_t timebase_get_ns(void);
+extern uint64_t timebase_get_us(void);
+extern uint64_t timebase_cycles_to_ns(uint64_t cycles);
+extern uint64_t timebase_cycles_to_us(uint64_t cycles);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_TIMEBASE_H_ */
+
+/********************** end of file ******************************************/
@@ -0,0 +1,100 @@
+/*
+ * trace.h
+ *
+ */
+
+#ifndef INC_TRACE_H_
+#define INC_TRACE_H_
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "main.h"
+
+/********************** macros ***********************************************/
+
+#define TRACE_CONFIG_ENABLE		(1)
+
+/* Entries kept (8 bytes each), must be a power of two. Oldest entries are
+ * overwritten */
+#define TRACE_CONFIG_SIZE		256ul
+
+/* "TRC1", lets tools/trace_export.py check the dump */
+#define TRACE_MAGIC				0x31435254ul
+
+#if 1 == TRACE_CONFIG_ENABLE
+#define TRACE_TICK(cnt)						trace_record(TRACE_EV_TICK, 0ul, (cnt))
+#define TRACE_TASK_BEGIN(index)				trace_record(TRACE_EV_TASK_BEGIN, (index), 0ul)
+#define TRACE_TASK_END(index)				trace_record(TRACE_EV_TASK_END, (index), 0ul)
+#define TRACE_QUEUE_PUT(queue, lane, event)	trace_record(TRACE_EV_QUEUE_PUT, (queue), ((uint32_t)(lane) << 8) | (uint32_t)(event))
+#define TRACE_QUEUE_GET(queue, lane, event)	trace_record(TRACE_EV_QUEUE_GET, (queue), ((uint32_t)(lane) << 8) | (uint32_t)(event))
+#define TRACE_ISR_ENTER()					trace_record(TRACE_EV_ISR_ENTER, __get_IPSR(), 0ul)
+#define TRACE_ISR_EXIT()					trace_record(TRACE_EV_ISR_EXIT, __get_IPSR(), 0ul)
+#else
+#define TRACE_TICK(cnt)
+#define TRACE_TASK_BEGIN(index)
+#define TRACE_TASK_END(index)
+#define TRACE_QUEUE_PUT(queue, lane, event)
+#define TRACE_QUEUE_GET(queue, lane, event)
+#define TRACE_ISR_ENTER()
+#define TRACE_ISR_EXIT()
+#endif
+
+/********************** typedef **********************************************/
+
+/* tools/trace_export.py decodes the same numbers */
+typedef enum trace_ev {TRACE_EV_TICK,			// arg: g_app_cnt (low 16 bits)
+					   TRACE_EV_TASK_BEGIN,		// id: task_cfg_list index
+					   TRACE_EV_TASK_END,
+					   TRACE_EV_QUEUE_PUT,		// id: trace_queue_t, arg: lane (LED, bar) << 8 | event (value)
+					   TRACE_EV_QUEUE_GET,
+					   TRACE_EV_ISR_ENTER,		// id: exception number (IPSR)
+					   TRACE_EV_ISR_EXIT} trace_ev_t;
+
+typedef enum trace_queue {TRACE_QUEUE_NORMAL,
+						  TRACE_QUEUE_SETUP,
+						  TRACE_QUEUE_ACTUATOR,
+						  TRACE_QUEUE_ACTUATOR_BAR} trace_queue_t;
+
+typedef struct
+{
+	uint32_t	cycle_counter;	// CYCCNT, 32 bit
+	uint8_t		type;			// trace_ev_t
+	uint8_t		id;
+	uint16_t	arg;
+} trace_entry_t;
+
+/* Read as a whole by the debugger (dump of the trace_recorder symbol) */
+typedef struct
+{
+	uint32_t			magic;
+	uint32_t			size;		// TRACE_CONFIG_SIZE
+	volatile uint32_t	head;		// Entries recorded, runs free
+	uint32_t			cpu_hz;		// CYCCNT clock
+	volatile uint32_t	enable;
+	trace_entry_t		entry[TRACE_CONFIG_SIZE];
+} trace_recorder_t;
+
+/********************** external data declaration ****************************/
+extern trace_recorder_t trace_recorder;
+
+/********************** external functions declaration ***********************/
+extern void trace_init(void);
+extern void trace_enable(bool b_enable);
+extern void trace_record(trace_ev_t type, uint32_t id, uint32_t arg);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_TRACE_H_ */
+
+/********************** end of file ******************************************/
@@ -40,16 +40,27 @@
 #include "task_normal.h"
 #include "task_setup.h"
 #include "task_shared_params.h"
+#include "flash_eeprom.h"
+#include "output_stage.h"
 #include "main.h"
+#include "sysmem.h"
 
 /* Demo includes. */
 #include "logger.h"
 #include "dwt.h"
+#include "itm_trace.h"
+#include "profile.h"
+#include "timebase.h"
+#include "trace.h"
+#include "irq_stat.h"
+#include "stack_monitor.h"
+#include "bench.h"
 
 /* Application & Tasks includes. */
 #include "board.h"
 #include "task_actuator.h"
 #include "task_sensor.h"
+#include "task_command.h"
 
 /********************** macros and definitions *******************************/
 #define G_APP_CNT_INI		0ul
@@ -71,15 +82,18 @@ typedef struct {
 } task_dta_t;
 
 /********************** internal data declaration ****************************/
-task_shared_params_dta_t shared_params = {
+const task_shared_params_dta_t shared_params_ini = {
     .pack_rate = DEL_SYST_MIN,
     .waiting_time = DEL_SYST_MIN
-};;
+};
+
+task_shared_params_t shared_params[SYST_LANE_QTY];
 
 task_cfg_t task_cfg_list[]	= {
 		{task_sensor_init, 		task_sensor_update, 	NULL},
-		{task_normal_init, 		task_normal_update, 	(void *)&shared_params},
-		{task_setup_init, 		task_setup_update, 	  	(void *)&shared_params},
+		{task_command_init, 	task_command_update, 	(void *)shared_params},
+		{task_normal_init, 		task_normal_update, 	(void *)shared_params},
+		{task_setup_init, 		task_setup_update, 	  	(void *)shared_params},
 		{task_actuator_init,	task_actuator_update, 	NULL}
 };
 
@@ -104,6 +118,15 @@ void app_init(void)
 {
 	uint32_t index;
 
+	/* SWO trace, before anything is logged */
+	itm_trace_init();
+
+	/* 64 bit CYCCNT clock, before anything is stamped */
+	timebase_init();
+	trace_init();
+	irq_stat_reset();
+	stack_monitor_init();
+
 	/* Print out: Application Initialized */
 	LOGGER_LOG("\r\n");
 	LOGGER_LOG("%s is running - Tick [mS] = %d\r\n", GET_NAME(app_init), (int)HAL_GetTick());
@@ -116,6 +139,27 @@ void app_init(void)
 	/* Print out: Application execution counter */
 	LOGGER_LOG(" %s = %d\r\n", GET_NAME(g_app_cnt), (int)g_app_cnt);
 
+	/* Init shared params of every lane */
+	for (index = 0; SYST_LANE_QTY > index; index++)
+	{
+		init_task_shared_params(&shared_params[index], &shared_params_ini);
+	}
+
+	/* Restore the shared params persisted by Task Setup, the defaults of
+	 * Task Normal stand if the EEPROM pages cannot even be formatted */
+	if (false == flash_eeprom_init())
+		LOGGER_LOG(" %s failed, params not persisted\r\n", GET_NAME(flash_eeprom_init));
+
+	/* Take over the GPIO outputs configured by MX_GPIO_Init */
+	output_stage_init();
+
+#if 1 == BENCH_CONFIG_ENABLE
+	/* Benchmark build: the suite drives the tasks itself, they start over
+	 * below and the profiling zones it went through are reset */
+	bench_run();
+	bench_dump();
+#endif
+
 	/* Go through the task arrays */
 	for (index = 0; TASK_QTY > index; index++)
 	{
@@ -126,7 +170,11 @@ void app_init(void)
 		task_dta_list[index].WCET = TASK_X_WCET_INI;
 	}
 
-	cycle_counter_init();
+	/* CYCCNT runs free (timebase), profiling zones nest inside tasks */
+	profile_init();
+
+	/* No allocation from here on, see sysmem.h */
+	sysmem_seal();
 }
 
 void app_update(void)
@@ -143,18 +191,31 @@ void app_update(void)
     	/* Update App Counter */
     	g_app_cnt++;
     	g_app_time_us = 0;
+    	TRACE_TICK(g_app_cnt);
+
+    	/* Less than STACK_MONITOR_GUARD bytes of stack left */
+    	if (stack_monitor_check())
+    	{
+    		LOGGER_ERROR("STACK GUARD HIT, USED %lu OF %lu\n", (unsigned long)stack_monitor_used(), (unsigned long)stack_monitor_size());
+    	}
 
     	/* Go through the task arrays */
     	for (index = 0; TASK_QTY > index; index++)
     	{
 			//HAL_GPIO_TogglePin(LED_A_PORT, LED_A_PIN);
-			cycle_counter_reset();
+			ITM_TRACE_TASK_START(index);
+			TRACE_TASK_BEGIN(index);
+			cycle_counter = cycle_counter_get();
+			PROFILE_ZONE_BEGIN(PROFILE_ZONE_TASK_SENSOR + index);
 
     		/* Run task_x_update */
 			(*task_cfg_list[index].task_update)(task_cfg_list[index].parameters);
 
-			cycle_counter = cycle_counter_get();
-			cycle_counter_time_us = cycle_counter_time_us();
+			PROFILE_ZONE_END(PROFILE_ZONE_TASK_SENSOR + index);
+			cycle_counter = cycle_counter_elapsed(cycle_counter);
+			ITM_TRACE_TASK_STOP(index);
+			TRACE_TASK_END(index);
+			cycle_counter_time_us = timebase_delta_to_us(cycle_counter);
 			//HAL_GPIO_TogglePin(LED_A_PORT, LED_A_PIN);
 
 			/* Update variables */
@@ -165,14 +226,20 @@ void app_update(void)
 				task_dta_list[index].WCET = cycle_counter_time_us;
 			}
 	    }
+
+    	/* Repeat counts of the limited logs gone quiet */
+    	logger_update();
     }
 }
 
 void HAL_SYSTICK_Callback(void)
 {
+	timebase_update();
+
 	g_app_tick_cnt++;
 
 	g_task_sensor_tick_cnt++;
+	g_task_command_tick_cnt++;
 	g_task_normal_tick_cnt++;
 	g_task_setup_tick_cnt++;
 	g_task_actuator_tick_cnt++;
@@ -0,0 +1,234 @@
+/*
+ * bench.c
+ *
+ */
+
+/* Task and queue benchmarks: the suite takes the place of app_update(),
+ * one tick at a time, and times each task_x_update(), the whole tick and a
+ * put/get pair on each queue (every lane of Task Normal). Packs come in
+ * and go out on every lane, so the tick item scales with SYST_LANE_QTY.
+ * Every call is timed on its own, so min is the figure to compare between
+ * changes, max also holds the interrupts taken meanwhile */
+
+/********************** inclusions *******************************************/
+/* Project includes. */
+#include "task_normal_attribute.h"
+#include "task_normal_interface.h"
+#include "task_setup_attribute.h"
+#include "task_setup_interface.h"
+#include "task_shared_params.h"
+#include "main.h"
+
+/* Demo includes. */
+#include "logger.h"
+
+/* Application & Tasks includes. */
+#include "board.h"
+#include "task_sensor.h"
+#include "task_normal.h"
+#include "task_setup.h"
+#include "task_actuator.h"
+#include "bench.h"
+
+/********************** macros and definitions *******************************/
+#define BENCH_MIN_INI			0xFFFFFFFFul
+
+/* Pack events in one direction before turning: past DEL_SYST_MAX_PACKS, so
+ * the buffer saturates and then drains completely */
+#define BENCH_BURST_LEN			(DEL_SYST_MAX_PACKS + 2ul)
+
+/********************** internal data declaration ****************************/
+
+/********************** internal functions declaration ***********************/
+static void bench_item_end(bench_scenario_t scenario, bench_item_t item, uint32_t cycle_counter);
+static void bench_tick(bench_scenario_t scenario);
+
+/********************** internal data definition *****************************/
+/* Indexed by bench_scenario_t */
+static const char * const bench_scenario_name[BENCH_SCENARIO_QTY] = {
+	"idle", "pack_burst", "setup_nav"
+};
+
+/* Indexed by bench_item_t */
+static const char * const bench_item_name[BENCH_ITEM_QTY] = {
+	"sensor", "normal", "setup", "actuator", "tick",
+	"put_normal", "get_normal", "put_setup", "get_setup"
+};
+
+/* From the initial menu as it opens: pack rate +2, back, waiting time +1,
+ * back */
+static const task_setup_ev_t bench_setup_key_list[] = {
+	EV_SETUP_ENTER, EV_SETUP_NEXT, EV_SETUP_NEXT, EV_SETUP_ESCAPE,
+	EV_SETUP_NEXT, EV_SETUP_ENTER, EV_SETUP_NEXT, EV_SETUP_ESCAPE
+};
+
+#define BENCH_SETUP_KEY_QTY	(sizeof(bench_setup_key_list)/sizeof(task_setup_ev_t))
+
+/* The suite publishes to its own params, never to the application ones */
+static task_shared_params_t bench_params[SYST_LANE_QTY];
+
+/********************** external data declaration ****************************/
+bench_result_t bench_result_list[BENCH_SCENARIO_QTY][BENCH_ITEM_QTY];
+
+/********************** internal functions definition ************************/
+static void bench_item_end(bench_scenario_t scenario, bench_item_t item, uint32_t cycle_counter) {
+	bench_result_t *p_result = &bench_result_list[scenario][item];
+	uint32_t cycles = BENCH_CYCLES_GET() - cycle_counter;
+
+	p_result->cnt++;
+	p_result->total += cycles;
+
+	if (p_result->min > cycles)
+		p_result->min = cycles;
+
+	if (p_result->max < cycles)
+		p_result->max = cycles;
+}
+
+/* One tick of app_update() for the four tasks, each one due exactly once,
+ * then a put/get pair on each queue they left empty. A queue still holding
+ * events is skipped, the get would take one of them */
+static void bench_tick(bench_scenario_t scenario) {
+	uint32_t tick_counter;
+	uint32_t cycle_counter;
+	uint32_t lane;
+
+	tick_counter = BENCH_CYCLES_GET();
+
+	g_task_sensor_tick_cnt = 1ul;
+	cycle_counter = BENCH_CYCLES_GET();
+	task_sensor_update(NULL);
+	bench_item_end(scenario, BENCH_ITEM_SENSOR, cycle_counter);
+
+	g_task_normal_tick_cnt = 1ul;
+	cycle_counter = BENCH_CYCLES_GET();
+	task_normal_update((void *)bench_params);
+	bench_item_end(scenario, BENCH_ITEM_NORMAL, cycle_counter);
+
+	g_task_setup_tick_cnt = 1ul;
+	cycle_counter = BENCH_CYCLES_GET();
+	task_setup_update((void *)bench_params);
+	bench_item_end(scenario, BENCH_ITEM_SETUP, cycle_counter);
+
+	g_task_actuator_tick_cnt = 1ul;
+	cycle_counter = BENCH_CYCLES_GET();
+	task_actuator_update(NULL);
+	bench_item_end(scenario, BENCH_ITEM_ACTUATOR, cycle_counter);
+
+	bench_item_end(scenario, BENCH_ITEM_TICK, tick_counter);
+
+	for (lane = 0; SYST_LANE_QTY > lane; lane++) {
+		if (true == any_event_task_normal(lane))
+			continue;
+
+		cycle_counter = BENCH_CYCLES_GET();
+		put_event_task_normal(EV_NML_IDLE, lane);
+		bench_item_end(scenario, BENCH_ITEM_PUT_NORMAL, cycle_counter);
+
+		cycle_counter = BENCH_CYCLES_GET();
+		get_event_task_normal(lane);
+		bench_item_end(scenario, BENCH_ITEM_GET_NORMAL, cycle_counter);
+	}
+
+	if (false == any_event_task_setup()) {
+		cycle_counter = BENCH_CYCLES_GET();
+		put_event_task_setup(EV_SETUP_IDLE);
+		bench_item_end(scenario, BENCH_ITEM_PUT_SETUP, cycle_counter);
+
+		cycle_counter = BENCH_CYCLES_GET();
+		get_event_task_setup(&lane);
+		bench_item_end(scenario, BENCH_ITEM_GET_SETUP, cycle_counter);
+	}
+}
+
+/********************** external functions definition ************************/
+/* Leaves the tasks in the state of the last scenario, Task Setup under a
+ * menu: run it before their task_x_init(), or start them over afterwards.
+ * Setup is entered as the DIP does and driven through the queues only,
+ * never left, so the EEPROM is not written */
+void bench_run(void) {
+	const task_shared_params_dta_t params_ini = {DEL_SYST_MIN, DEL_SYST_MIN};
+	uint32_t scenario;
+	uint32_t item;
+	uint32_t lane;
+	uint32_t run;
+
+	for (scenario = 0; BENCH_SCENARIO_QTY > scenario; scenario++) {
+		for (item = 0; BENCH_ITEM_QTY > item; item++) {
+			bench_result_list[scenario][item].cnt = 0ul;
+			bench_result_list[scenario][item].total = 0ull;
+			bench_result_list[scenario][item].min = BENCH_MIN_INI;
+			bench_result_list[scenario][item].max = 0ul;
+		}
+	}
+
+	for (lane = 0; SYST_LANE_QTY > lane; lane++)
+		init_task_shared_params(&bench_params[lane], &params_ini);
+
+	task_sensor_init(NULL);
+	task_normal_init((void *)bench_params);
+	task_setup_init((void *)bench_params);
+	task_actuator_init(NULL);
+
+	/* Inputs as they are, no event reaches the tasks */
+	for (run = 0; BENCH_CONFIG_RUNS > run; run++)
+		bench_tick(BENCH_SCENARIO_IDLE);
+
+	/* Every lane under control (not timed), then packs in and out in turns
+	 * on all of them */
+	for (lane = 0; SYST_LANE_QTY > lane; lane++)
+		put_event_task_normal(EV_NML_SYST_CTRL_ON, lane);
+
+	g_task_normal_tick_cnt = 1ul;
+	task_normal_update((void *)bench_params);
+
+	for (run = 0; BENCH_CONFIG_RUNS > run; run++) {
+		for (lane = 0; SYST_LANE_QTY > lane; lane++)
+			put_event_task_normal((0ul == ((run / BENCH_BURST_LEN) & 1ul)) ? EV_NML_PACK_IN : EV_NML_PACK_OUT, lane);
+
+		bench_tick(BENCH_SCENARIO_PACK_BURST);
+	}
+
+	/* Setup switched on as the DIP does (not timed): Task Normal asks Task
+	 * Setup for lane 0, Task Setup opens the initial menu and answers. Run
+	 * until both have taken every event, so no key is queued behind them.
+	 * Then a key per tick */
+	put_event_task_normal(EV_NML_SETUP_SW_ON, SYST_LANE_0);
+
+	do {
+		g_task_normal_tick_cnt = 1ul;
+		task_normal_update((void *)bench_params);
+		g_task_setup_tick_cnt = 1ul;
+		task_setup_update((void *)bench_params);
+	} while ((true == any_event_task_setup()) || (true == any_event_task_normal(SYST_LANE_0)));
+
+	for (run = 0; BENCH_CONFIG_RUNS > run; run++) {
+		put_event_task_setup(bench_setup_key_list[run % BENCH_SETUP_KEY_QTY]);
+		bench_tick(BENCH_SCENARIO_SETUP_NAV);
+	}
+}
+
+/* One line per scenario & item: names, runs, min, avg & max cycles */
+void bench_dump(void) {
+	const bench_result_t *p_result;
+	uint32_t scenario;
+	uint32_t item;
+
+	LOGGER_LOG("bench lanes %lu\r\n", (unsigned long)SYST_LANE_QTY);
+	LOGGER_LOG("bench scenario item runs min avg max [cycles]\r\n");
+
+	for (scenario = 0; BENCH_SCENARIO_QTY > scenario; scenario++) {
+		for (item = 0; BENCH_ITEM_QTY > item; item++) {
+			p_result = &bench_result_list[scenario][item];
+
+			if (0ul == p_result->cnt)
+				continue;
+
+			LOGGER_LOG("bench %s %s %lu %lu %lu %lu\r\n", bench_scenario_name[scenario], bench_item_name[item],
+					   (unsigned long)p_result->cnt, (unsigned long)p_result->min, (unsigned long)(p_result->total / p_result->cnt),
+					   (unsigned long)p_result->max);
+		}
+	}
+}
+
+/********************** end of file ******************************************/
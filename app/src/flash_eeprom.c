@@ -0,0 +1,291 @@
+/*
+ * flash_eeprom.c
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <stddef.h>
+
+/* Project includes. */
+#include "main.h"
+#include "string.h"
+
+/* Application & Tasks includes. */
+#include "flash_eeprom.h"
+
+/********************** macros and definitions *******************************/
+/* Page states, each one only clears bits of the previous one */
+#define FLASH_EEPROM_PAGE_ERASED	0xFFFFu
+#define FLASH_EEPROM_PAGE_RECEIVE	0xEEEEu
+#define FLASH_EEPROM_PAGE_ACTIVE	0x0000u
+
+#define FLASH_EEPROM_RECORD_MAGIC	0xA55Au
+#define FLASH_EEPROM_RECORD_ERASED	0xFFFFu
+
+#define FLASH_EEPROM_SLOT_SIZE		(sizeof(flash_eeprom_record_t))
+#define FLASH_EEPROM_RECORD_QTY		((FLASH_PAGE_SIZE / FLASH_EEPROM_SLOT_SIZE) - 1ul)
+
+#define FLASH_EEPROM_CRC_INI		0xFFFFu
+#define FLASH_EEPROM_CRC_POLY		0x1021u
+
+#define FLASH_EEPROM_PAGE_NONE		FLASH_EEPROM_PAGE_QTY
+
+/********************** internal data declaration ****************************/
+extern uint8_t _flash_eeprom_start[];
+
+/********************** internal functions declaration ***********************/
+static uint32_t flash_eeprom_page_addr(uint32_t page);
+static const flash_eeprom_header_t *flash_eeprom_header(uint32_t page);
+static const flash_eeprom_record_t *flash_eeprom_record(uint32_t page, uint32_t index);
+static uint16_t flash_eeprom_crc(const flash_eeprom_record_t *p_record);
+static bool flash_eeprom_erase(uint32_t page);
+static bool flash_eeprom_program(uint32_t addr, const void *p_slot);
+static bool flash_eeprom_append(uint32_t page, uint32_t index, uint32_t lane, const task_shared_params_dta_t *p_dta);
+static bool flash_eeprom_rotate(void);
+
+/********************** internal data definition *****************************/
+static uint32_t flash_eeprom_active;		// Active page
+static uint32_t flash_eeprom_generation;	// Generation of the active page
+static uint32_t flash_eeprom_cursor;		// Next free record slot of the active page
+
+/* Latest record of each lane, so reads never touch flash */
+static task_shared_params_dta_t flash_eeprom_cache[SYST_LANE_QTY];
+static bool flash_eeprom_valid[SYST_LANE_QTY];
+
+/********************** external data declaration ****************************/
+
+/********************** internal functions definition ************************/
+static uint32_t flash_eeprom_page_addr(uint32_t page) {
+	return (uint32_t)(uintptr_t)_flash_eeprom_start + (page * FLASH_PAGE_SIZE);
+}
+
+static const flash_eeprom_header_t *flash_eeprom_header(uint32_t page) {
+	return (const flash_eeprom_header_t *)(uintptr_t)flash_eeprom_page_addr(page);
+}
+
+static const flash_eeprom_record_t *flash_eeprom_record(uint32_t page, uint32_t index) {
+	return (const flash_eeprom_record_t *)(uintptr_t)(flash_eeprom_page_addr(page) + ((index + 1ul) * FLASH_EEPROM_SLOT_SIZE));
+}
+
+/* CRC-16/CCITT over every field but the crc itself */
+static uint16_t flash_eeprom_crc(const flash_eeprom_record_t *p_record) {
+	const uint8_t *p_byte = (const uint8_t *)p_record;
+	uint16_t crc = FLASH_EEPROM_CRC_INI;
+	uint32_t index;
+	uint32_t bit;
+
+	for (index = 0; offsetof(flash_eeprom_record_t, crc) > index; index++) {
+		crc ^= (uint16_t)((uint16_t)p_byte[index] << 8);
+
+		for (bit = 0; 8ul > bit; bit++)
+			crc = (crc & 0x8000u) ? (uint16_t)((crc << 1) ^ FLASH_EEPROM_CRC_POLY) : (uint16_t)(crc << 1);
+	}
+
+	return crc;
+}
+
+static bool flash_eeprom_erase(uint32_t page) {
+	FLASH_EraseInitTypeDef erase_init;
+	uint32_t page_error;
+	HAL_StatusTypeDef status;
+
+	erase_init.TypeErase = FLASH_TYPEERASE_PAGES;
+	erase_init.Banks = FLASH_BANK_1;
+	erase_init.PageAddress = flash_eeprom_page_addr(page);
+	erase_init.NbPages = 1;
+
+	HAL_FLASH_Unlock();
+	status = HAL_FLASHEx_Erase(&erase_init, &page_error);
+	HAL_FLASH_Lock();
+
+	return (HAL_OK == status);
+}
+
+/* Program one 8 byte slot (record or page header) */
+static bool flash_eeprom_program(uint32_t addr, const void *p_slot) {
+	uint64_t data;
+	HAL_StatusTypeDef status;
+
+	memcpy(&data, p_slot, sizeof(data));
+
+	HAL_FLASH_Unlock();
+	status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, addr, data);
+	HAL_FLASH_Lock();
+
+	return (HAL_OK == status);
+}
+
+static bool flash_eeprom_append(uint32_t page, uint32_t index, uint32_t lane, const task_shared_params_dta_t *p_dta) {
+	flash_eeprom_record_t record;
+
+	record.magic = FLASH_EEPROM_RECORD_MAGIC;
+	record.lane = (uint8_t)lane;
+	record.pack_rate = (uint8_t)p_dta->pack_rate;
+	record.waiting_time = (uint8_t)p_dta->waiting_time;
+	record.reserved = 0xFFu;
+	record.crc = flash_eeprom_crc(&record);
+
+	return flash_eeprom_program((uint32_t)(uintptr_t)flash_eeprom_record(page, index), &record);
+}
+
+/* Move the latest record of every lane to the next page of the ring (the
+ * first one on blank storage), then release the full one. The new page only
+ * becomes ACTIVE once complete, and the module only moves to it then: a
+ * failure or a reset at any point leaves one consistent page */
+static bool flash_eeprom_rotate(void) {
+	flash_eeprom_header_t header;
+	uint32_t page_old = flash_eeprom_active;
+	uint32_t page_new = 0;
+	uint32_t generation = 0;
+	uint32_t cursor = 0;
+	uint32_t lane;
+	HAL_StatusTypeDef status;
+
+	if (FLASH_EEPROM_PAGE_NONE != page_old) {
+		page_new = (page_old + 1ul) % FLASH_EEPROM_PAGE_QTY;
+		generation = (flash_eeprom_generation + 1ul) & 0xFFFFul;
+	}
+
+	if (false == flash_eeprom_erase(page_new))
+		return false;
+
+	header.state = FLASH_EEPROM_PAGE_RECEIVE;
+	header.generation = (uint16_t)generation;
+	header.reserved = 0xFFFFFFFFul;
+
+	if (false == flash_eeprom_program(flash_eeprom_page_addr(page_new), &header))
+		return false;
+
+	for (lane = 0; SYST_LANE_QTY > lane; lane++) {
+		if (false == flash_eeprom_valid[lane])
+			continue;
+
+		if (false == flash_eeprom_append(page_new, cursor, lane, &flash_eeprom_cache[lane]))
+			return false;
+
+		cursor++;
+	}
+
+	/* RECEIVE -> ACTIVE: 0x0000 may be programmed over a written half-word */
+	HAL_FLASH_Unlock();
+	status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, flash_eeprom_page_addr(page_new), FLASH_EEPROM_PAGE_ACTIVE);
+	HAL_FLASH_Lock();
+
+	if (HAL_OK != status)
+		return false;
+
+	flash_eeprom_active = page_new;
+	flash_eeprom_generation = generation;
+	flash_eeprom_cursor = cursor;
+
+	/* Both pages ACTIVE until this erase completes, the newest one wins */
+	return (FLASH_EEPROM_PAGE_NONE == page_old) || flash_eeprom_erase(page_old);
+}
+
+/********************** external functions definition ************************/
+/* Boot restore: pick the newest ACTIVE page, binary search its write cursor
+ * (records are contiguous from the start of the page) and walk backwards
+ * only until every lane has its latest valid record. Returns false if blank
+ * storage could not be formatted: reads then find nothing and writes fail */
+bool flash_eeprom_init(void) {
+	const flash_eeprom_header_t *p_header;
+	const flash_eeprom_record_t *p_record;
+	uint32_t page;
+	uint32_t lane;
+	uint32_t lane_qty = 0;
+	uint32_t index_low;
+	uint32_t index_high;
+	uint32_t index;
+
+	flash_eeprom_active = FLASH_EEPROM_PAGE_NONE;
+	flash_eeprom_generation = 0;
+	flash_eeprom_cursor = 0;
+
+	for (lane = 0; SYST_LANE_QTY > lane; lane++)
+		flash_eeprom_valid[lane] = false;
+
+	for (page = 0; FLASH_EEPROM_PAGE_QTY > page; page++) {
+		p_header = flash_eeprom_header(page);
+
+		if (FLASH_EEPROM_PAGE_ACTIVE != p_header->state)
+			continue;
+
+		if ((FLASH_EEPROM_PAGE_NONE == flash_eeprom_active)
+				|| (0 < (int16_t)(p_header->generation - (uint16_t)flash_eeprom_generation))) {
+			flash_eeprom_active = page;
+			flash_eeprom_generation = p_header->generation;
+		}
+	}
+
+	/* Blank (or never completed) storage: format the first page */
+	if (FLASH_EEPROM_PAGE_NONE == flash_eeprom_active)
+		return flash_eeprom_rotate();
+
+	index_low = 0;
+	index_high = FLASH_EEPROM_RECORD_QTY;
+
+	while (index_low < index_high) {
+		index = (index_low + index_high) >> 1;
+
+		if (FLASH_EEPROM_RECORD_ERASED == flash_eeprom_record(flash_eeprom_active, index)->magic)
+			index_high = index;
+		else
+			index_low = index + 1ul;
+	}
+
+	flash_eeprom_cursor = index_low;
+
+	for (index = flash_eeprom_cursor; (0ul < index) && (SYST_LANE_QTY > lane_qty); index--) {
+		p_record = flash_eeprom_record(flash_eeprom_active, index - 1ul);
+
+		if ((FLASH_EEPROM_RECORD_MAGIC != p_record->magic)
+				|| (SYST_LANE_QTY <= p_record->lane)
+				|| (flash_eeprom_crc(p_record) != p_record->crc)
+				|| (true == flash_eeprom_valid[p_record->lane]))
+			continue;
+
+		flash_eeprom_cache[p_record->lane].pack_rate = p_record->pack_rate;
+		flash_eeprom_cache[p_record->lane].waiting_time = p_record->waiting_time;
+		flash_eeprom_valid[p_record->lane] = true;
+		lane_qty++;
+	}
+
+	return true;
+}
+
+bool flash_eeprom_read(uint32_t lane, task_shared_params_dta_t *p_dta) {
+	if (false == flash_eeprom_valid[lane])
+		return false;
+
+	*p_dta = flash_eeprom_cache[lane];
+
+	return true;
+}
+
+/* Append a record only if the values changed. Programming stalls the CPU for
+ * tens of microseconds, and a page erase (once every FLASH_EEPROM_RECORD_QTY
+ * writes) for tens of milliseconds */
+bool flash_eeprom_write(uint32_t lane, const task_shared_params_dta_t *p_dta) {
+	if ((true == flash_eeprom_valid[lane])
+			&& (flash_eeprom_cache[lane].pack_rate == p_dta->pack_rate)
+			&& (flash_eeprom_cache[lane].waiting_time == p_dta->waiting_time))
+		return true;
+
+	if (FLASH_EEPROM_PAGE_NONE == flash_eeprom_active)
+		return false;
+
+	if ((FLASH_EEPROM_RECORD_QTY <= flash_eeprom_cursor) && (false == flash_eeprom_rotate()))
+		return false;
+
+	if (false == flash_eeprom_append(flash_eeprom_active, flash_eeprom_cursor, lane, p_dta))
+		return false;
+
+	flash_eeprom_cursor++;
+
+	flash_eeprom_cache[lane] = *p_dta;
+	flash_eeprom_valid[lane] = true;
+
+	return true;
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,87 @@
+/*
+ * irq_stat.c
+ *
+ */
+
+/********************** inclusions *******************************************/
+/* Project includes. */
+#include "main.h"
+#include "string.h"
+
+/* Demo includes. */
+#include "logger.h"
+
+/* Application & Tasks includes. */
+#include "irq_stat.h"
+
+/********************** macros and definitions *******************************/
+
+/********************** internal data declaration ****************************/
+
+/********************** internal functions declaration ***********************/
+
+/********************** internal data definition *****************************/
+/* Indexed by irq_stat_src_t */
+static const char * const irq_stat_name[IRQ_STAT_SRC_QTY] = {
+	"systick", "cs_sensor", "cs_command", "cs_normal", "cs_setup", "cs_actuator"
+};
+
+/********************** external data declaration ****************************/
+irq_stat_t irq_stat_list[IRQ_STAT_SRC_QTY];
+uint32_t irq_stat_cs_start;
+
+/********************** internal functions definition ************************/
+
+/********************** external functions definition ************************/
+void irq_stat_reset(void) {
+	memset(irq_stat_list, 0, sizeof(irq_stat_list));
+}
+
+/* Every source is recorded from a single context. Called with interrupts
+ * masked by the critical sections, so kept to a CLZ and a few stores */
+void irq_stat_record(irq_stat_src_t src, uint32_t cycles) {
+	irq_stat_t *p_stat = &irq_stat_list[src];
+	uint32_t bucket = 32ul - __CLZ(cycles);
+
+	if (IRQ_STAT_HIST_QTY <= bucket)
+		bucket = IRQ_STAT_HIST_QTY - 1ul;
+
+	p_stat->cnt++;
+	p_stat->hist[bucket]++;
+
+	if (p_stat->max < cycles)
+		p_stat->max = cycles;
+}
+
+/* Per source: count, worst case and the non empty buckets as
+ * <first cycle of the bucket>:<count>. One line per call, so the caller
+ * paces them to the UART: *p_cursor starts at 0, false once all are out */
+bool irq_stat_dump(uint32_t *p_cursor) {
+	const irq_stat_t *p_stat;
+	uint32_t src;
+	uint32_t bucket;
+
+	/* Each source takes its count line and one line per bucket */
+	while ((IRQ_STAT_SRC_QTY * (IRQ_STAT_HIST_QTY + 1ul)) > *p_cursor) {
+		src = *p_cursor / (IRQ_STAT_HIST_QTY + 1ul);
+		bucket = *p_cursor % (IRQ_STAT_HIST_QTY + 1ul);
+		p_stat = &irq_stat_list[src];
+		(*p_cursor)++;
+
+		if (0ul == bucket) {
+			LOGGER_LOG("irq %s %lu max %lu\r\n", irq_stat_name[src], (unsigned long)p_stat->cnt, (unsigned long)p_stat->max);
+			return true;
+		}
+
+		bucket--;
+
+		if (0ul != p_stat->hist[bucket]) {
+			LOGGER_LOG("irq %s %lu:%lu\r\n", irq_stat_name[src], (0ul == bucket) ? 0ul : (1ul << (bucket - 1ul)), (unsigned long)p_stat->hist[bucket]);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/********************** end of file ******************************************/
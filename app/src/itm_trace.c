@@ -0,0 +1,87 @@
+/*
+ * itm_trace.c
+ *
+ */
+
+/********************** inclusions *******************************************/
+/* Project includes. */
+#include "main.h"
+#include "string.h"
+
+/* Application & Tasks includes. */
+#include "itm_trace.h"
+
+/********************** macros and definitions *******************************/
+#define ITM_TRACE_LAR_KEY		0xC5ACCE55ul
+#define ITM_TRACE_BUS_ID		1ul
+#define ITM_TRACE_PORTS			((1ul << ITM_TRACE_PORT_LOG) | (1ul << ITM_TRACE_PORT_TASK_START) | (1ul << ITM_TRACE_PORT_TASK_STOP)\
+								| (1ul << ITM_TRACE_PORT_LOG_ISR))
+
+/********************** internal data declaration ****************************/
+
+/********************** internal functions declaration ***********************/
+static bool itm_trace_port_enabled(uint32_t port);
+
+/********************** internal data definition *****************************/
+
+/********************** external data declaration ****************************/
+volatile uint32_t itm_trace_drop_cnt;
+
+/********************** internal functions definition ************************/
+static bool itm_trace_port_enabled(uint32_t port) {
+	return (0ul != (ITM->TCR & ITM_TCR_ITMENA_Msk)) && (0ul != (ITM->TER & (1ul << port)));
+}
+
+/********************** external functions definition ************************/
+/* Only with a debugger attached, which also sets up the TPIU (SWO baud rate)
+ * from the SWV settings. Otherwise the ITM stays off and writes are no-ops */
+void itm_trace_init(void) {
+	itm_trace_drop_cnt = 0ul;
+
+	if (0ul == (CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk))
+		return;
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+	/* PB3 as asynchronous TRACESWO */
+	DBGMCU->CR = (DBGMCU->CR & ~DBGMCU_CR_TRACE_MODE) | DBGMCU_CR_TRACE_IOEN;
+
+	ITM->LAR = ITM_TRACE_LAR_KEY;
+	ITM->TCR = (ITM_TRACE_BUS_ID << ITM_TCR_TraceBusID_Pos) | ITM_TCR_SYNCENA_Msk | ITM_TCR_TSENA_Msk | ITM_TCR_ITMENA_Msk;
+	ITM->TER |= ITM_TRACE_PORTS;
+}
+
+/* Word writes while possible, each one waits for a free stimulus FIFO slot */
+void itm_trace_write(uint32_t port, const void *p_data, uint32_t len) {
+	const uint8_t *p_byte = (const uint8_t *)p_data;
+	uint32_t word;
+
+	if (false == itm_trace_port_enabled(port))
+		return;
+
+	for (; 4ul <= len; len -= 4ul, p_byte += 4) {
+		memcpy(&word, p_byte, sizeof(word));
+		while (0ul == ITM->PORT[port].u32) {}
+		ITM->PORT[port].u32 = word;
+	}
+
+	for (; 0ul < len; len--, p_byte++) {
+		while (0ul == ITM->PORT[port].u32) {}
+		ITM->PORT[port].u8 = *p_byte;
+	}
+}
+
+/* Never waits: with the FIFO full the marker is dropped and counted */
+void itm_trace_marker(uint32_t port, uint32_t value) {
+	if (false == itm_trace_port_enabled(port))
+		return;
+
+	if (0ul == ITM->PORT[port].u32) {
+		itm_trace_drop_cnt++;
+		return;
+	}
+
+	ITM->PORT[port].u8 = (uint8_t)value;
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,175 @@
+/*
+ * led_timer.c
+ *
+ */
+
+/********************** inclusions *******************************************/
+/* Project includes. */
+#include "main.h"
+
+/* Application & Tasks includes. */
+#include "led_timer.h"
+
+/********************** macros and definitions *******************************/
+/* Output compare modes (OCxM) */
+#define LED_TIMER_OCM_TOGGLE		0x3ul
+#define LED_TIMER_OCM_FORCE_OFF		0x4ul
+#define LED_TIMER_OCM_FORCE_ON		0x5ul
+#define LED_TIMER_OCM_PWM2			0x7ul
+
+#define LED_TIMER_OCM_MASK			0x7ul
+#define LED_TIMER_OCM_POS			4ul
+
+#define LED_TIMER_CHANNEL_MIN		1ul
+#define LED_TIMER_CHANNEL_MAX		4ul
+#define LED_TIMER_CHANNEL_FREE		0ul
+
+/********************** internal data declaration ****************************/
+
+/********************** internal functions declaration ***********************/
+static uint32_t led_timer_index(TIM_TypeDef *tim);
+static uint32_t led_timer_clk(TIM_TypeDef *tim);
+static void led_timer_mode(TIM_TypeDef *tim, uint32_t channel, uint32_t mode);
+static void led_timer_start(TIM_TypeDef *tim, uint32_t channel, uint32_t mode, uint32_t ms, bool one_pulse);
+
+/********************** internal data definition *****************************/
+/* General purpose & advanced timers of the F103, and the channel that owns
+ * each one: starting or forcing a channel reprograms the whole counter, so
+ * a timer drives one LED only */
+static TIM_TypeDef * const led_timer_list[] = {TIM1, TIM2, TIM3, TIM4};
+
+#define LED_TIMER_QTY	(sizeof(led_timer_list)/sizeof(TIM_TypeDef *))
+
+static uint32_t led_timer_owner[LED_TIMER_QTY];
+
+/********************** external data declaration ****************************/
+
+/********************** internal functions definition ************************/
+/* LED_TIMER_QTY when tim is none of led_timer_list */
+static uint32_t led_timer_index(TIM_TypeDef *tim) {
+	uint32_t index;
+
+	for (index = 0; (LED_TIMER_QTY > index) && (tim != led_timer_list[index]); index++)
+		;
+
+	return index;
+}
+
+/* Timer kernel clock: PCLKx, doubled when the APB prescaler is not 1 */
+static uint32_t led_timer_clk(TIM_TypeDef *tim) {
+	uint32_t clk;
+
+	if (TIM1 == tim) {
+		clk = HAL_RCC_GetPCLK2Freq();
+		if (RCC_HCLK_DIV1 != (RCC->CFGR & RCC_CFGR_PPRE2))
+			clk *= 2ul;
+	}
+	else {
+		clk = HAL_RCC_GetPCLK1Freq();
+		if (RCC_HCLK_DIV1 != (RCC->CFGR & RCC_CFGR_PPRE1))
+			clk *= 2ul;
+	}
+
+	return clk;
+}
+
+/* channel is 1..4 */
+static void led_timer_mode(TIM_TypeDef *tim, uint32_t channel, uint32_t mode) {
+	volatile uint32_t *p_ccmr = (2ul >= channel) ? &tim->CCMR1 : &tim->CCMR2;
+	uint32_t pos = (((channel - 1ul) & 1ul) * 8ul) + LED_TIMER_OCM_POS;
+
+	*p_ccmr = (*p_ccmr & ~(LED_TIMER_OCM_MASK << pos)) | (mode << pos);
+}
+
+static void led_timer_start(TIM_TypeDef *tim, uint32_t channel, uint32_t mode, uint32_t ms, bool one_pulse) {
+	volatile uint32_t *p_ccr = &tim->CCR1 + (channel - 1ul);
+
+	if (LED_TIMER_MAX_MS < ms)
+		ms = LED_TIMER_MAX_MS;
+	if (0ul == ms)
+		ms = 1ul;
+
+	tim->CR1 &= ~(TIM_CR1_CEN | TIM_CR1_OPM);
+	tim->ARR = (ms * LED_TIMER_CNT_PER_MS) - 1ul;
+	tim->CNT = 0ul;
+
+	/* Toggle: the output flips once per period, PWM2: active from the match
+	 * until the one pulse counter stops */
+	*p_ccr = (LED_TIMER_OCM_PWM2 == mode) ? 1ul : tim->ARR;
+
+	led_timer_mode(tim, channel, mode);
+
+	if (one_pulse) {
+		tim->ARR += 1ul;
+		tim->CR1 |= TIM_CR1_OPM;
+	}
+
+	tim->CR1 |= TIM_CR1_CEN;
+}
+
+/********************** external functions definition ************************/
+/* Route the LED pin to the timer channel and park the output inactive.
+ * False, and nothing touched, for an unknown timer or channel, or a timer
+ * another channel already owns */
+bool led_timer_init(TIM_TypeDef *tim, uint32_t channel, GPIO_TypeDef *gpio_port, uint16_t pin, bool active_high) {
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+	uint32_t index = led_timer_index(tim);
+	uint32_t pos = (channel - 1ul) * 4ul;
+
+	if ((LED_TIMER_QTY == index) || (LED_TIMER_CHANNEL_MIN > channel) || (LED_TIMER_CHANNEL_MAX < channel))
+		return false;
+
+	if ((LED_TIMER_CHANNEL_FREE != led_timer_owner[index]) && (channel != led_timer_owner[index]))
+		return false;
+
+	led_timer_owner[index] = channel;
+
+	if (TIM1 == tim)
+		__HAL_RCC_TIM1_CLK_ENABLE();
+	else if (TIM2 == tim)
+		__HAL_RCC_TIM2_CLK_ENABLE();
+	else if (TIM3 == tim)
+		__HAL_RCC_TIM3_CLK_ENABLE();
+	else
+		__HAL_RCC_TIM4_CLK_ENABLE();
+
+	tim->CR1 = 0ul;
+	tim->PSC = (led_timer_clk(tim) / LED_TIMER_CNT_FREQ_HZ) - 1ul;
+	tim->EGR = TIM_EGR_UG;
+
+	led_timer_mode(tim, channel, LED_TIMER_OCM_FORCE_OFF);
+
+	tim->CCER = (tim->CCER & ~(TIM_CCER_CC1P << pos)) | ((active_high ? 0ul : TIM_CCER_CC1P) << pos) | (TIM_CCER_CC1E << pos);
+
+	if (TIM1 == tim)
+		tim->BDTR |= TIM_BDTR_MOE;
+
+	GPIO_InitStruct.Pin = pin;
+	GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+	HAL_GPIO_Init(gpio_port, &GPIO_InitStruct);
+
+	return true;
+}
+
+void led_timer_force(TIM_TypeDef *tim, uint32_t channel, bool active) {
+	tim->CR1 &= ~TIM_CR1_CEN;
+	led_timer_mode(tim, channel, active ? LED_TIMER_OCM_FORCE_ON : LED_TIMER_OCM_FORCE_OFF);
+}
+
+/* Free running toggle, the output starts active and flips every half period */
+void led_timer_blink(TIM_TypeDef *tim, uint32_t channel, uint32_t half_period_ms) {
+	led_timer_force(tim, channel, true);
+	led_timer_start(tim, channel, LED_TIMER_OCM_TOGGLE, half_period_ms, false);
+}
+
+/* One pulse: the counter stops (CEN cleared by hardware) at the end */
+void led_timer_pulse(TIM_TypeDef *tim, uint32_t channel, uint32_t width_ms) {
+	led_timer_start(tim, channel, LED_TIMER_OCM_PWM2, width_ms, true);
+}
+
+bool led_timer_busy(TIM_TypeDef *tim) {
+	return (0ul != (tim->CR1 & TIM_CR1_CEN));
+}
+
+/********************** end of file ******************************************/
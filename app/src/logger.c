@@ -45,35 +45,365 @@
 #include "main.h"
 
 #include "logger.h"
+#include "itm_trace.h"
 
 /********************** macros and definitions *******************************/
 
+#define LOGGER_RING_MASK_       (LOGGER_CONFIG_RING_SIZE - 1)
+
+#define LOGGER_HASH_INI_        (2166136261ul)  // FNV-1a
+#define LOGGER_HASH_PRIME_      (16777619ul)
+
 /********************** internal data declaration ****************************/
 
 /********************** internal functions declaration ***********************/
 
+static bool logger_tx_claim_(void);
+static void logger_tx_kick_(void);
+static bool logger_ring_reserve_(uint32_t len, uint32_t* p_head);
+static void logger_ring_commit_(void);
+static uint32_t logger_hash_(const uint32_t* args, uint32_t qty);
+static void logger_logd_repeat_(logger_site_t* site, uint32_t now);
+
 /********************** internal data definition *****************************/
 
+/* Multi producer (thread mode & interrupts) / single consumer (USART2 TX
+ * DMA) ring. Producers reserve space moving head, copy, then commit; the
+ * consumer sends up to ready and moves tail. The indexes run free, their
+ * differences are the fill levels */
+static char logger_ring_[LOGGER_CONFIG_RING_SIZE];
+static volatile uint32_t logger_ring_head_;     // End of the reserved bytes
+static volatile uint32_t logger_ring_ready_;    // End of the complete bytes
+static volatile uint32_t logger_ring_tail_;     // End of the sent bytes
+static volatile uint32_t logger_ring_writers_;  // Reservations not committed
+
+static volatile uint32_t logger_tx_busy_;   // A DMA transfer is in flight
+static volatile uint32_t logger_tx_len_;    // Length of that transfer
+
+static logger_site_t* logger_site_list_;    // Limited log sites, see logger_update()
+
 /********************** external data definition *****************************/
 
-static char logger_msg_buffer_[LOGGER_CONFIG_MAXLEN];
-char* const logger_msg = logger_msg_buffer_;
+extern UART_HandleTypeDef huart2;
+
 int logger_msg_len;
+volatile uint32_t logger_drop_cnt;
+volatile uint32_t logger_level = LOGGER_CONFIG_LEVEL_RUNTIME;
 
 /********************** internal functions definition ************************/
 
+/* Exclusive access, so thread mode and the TX complete interrupt never
+ * start a transfer at the same time */
+static bool logger_tx_claim_(void)
+{
+    do
+    {
+        if (0 != __LDREXW(&logger_tx_busy_))
+        {
+            __CLREX();
+            return false;
+        }
+    } while (0 != __STREXW(1, &logger_tx_busy_));
+
+    __DMB();
+
+    return true;
+}
+
+/* On a single core an interrupt producer always commits before the producer
+ * it preempted resumes, so reservations nest. Exception entry clears the
+ * exclusive monitor, any preempted LDREX/STREX sequence retries */
+static bool logger_ring_reserve_(uint32_t len, uint32_t* p_head)
+{
+    uint32_t head;
+    uint32_t writers;
+
+    do
+    {
+        writers = __LDREXW(&logger_ring_writers_);
+    } while (0 != __STREXW(writers + 1, &logger_ring_writers_));
+
+    do
+    {
+        head = __LDREXW(&logger_ring_head_);
+
+        if (len > (LOGGER_CONFIG_RING_SIZE - (head - logger_ring_tail_)))
+        {
+            __CLREX();
+            logger_ring_commit_();
+            return false;
+        }
+    } while (0 != __STREXW(head + len, &logger_ring_head_));
+
+    *p_head = head;
+
+    return true;
+}
+
+/* The outermost producer publishes every reservation nested in its own.
+ * Reading head inside the exclusive sequence keeps ready from moving back
+ * if a new producer runs in between */
+static void logger_ring_commit_(void)
+{
+    uint32_t writers;
+
+    __DMB();
+
+    do
+    {
+        writers = __LDREXW(&logger_ring_writers_);
+    } while (0 != __STREXW(writers - 1, &logger_ring_writers_));
+
+    if (1 != writers)
+    {
+        return;
+    }
+
+    do
+    {
+        (void)__LDREXW(&logger_ring_ready_);
+    } while (0 != __STREXW(logger_ring_head_, &logger_ring_ready_));
+}
+
+/* Send the longest contiguous run of committed bytes */
+static void logger_tx_kick_(void)
+{
+    uint32_t tail;
+    uint32_t len;
+
+    while (logger_tx_claim_())
+    {
+        tail = logger_ring_tail_;
+        len = logger_ring_ready_ - tail;
+
+        if (0 == len)
+        {
+            logger_tx_busy_ = 0;
+            __DMB();
+
+            /* A producer may have failed to claim while we held the flag */
+            if (logger_ring_ready_ != logger_ring_tail_)
+            {
+                continue;
+            }
+            return;
+        }
+
+        if (len > (LOGGER_CONFIG_RING_SIZE - (tail & LOGGER_RING_MASK_)))
+        {
+            len = LOGGER_CONFIG_RING_SIZE - (tail & LOGGER_RING_MASK_);
+        }
+
+        logger_tx_len_ = len;
+
+        if (HAL_OK != HAL_UART_Transmit_DMA(&huart2, (uint8_t *)&logger_ring_[tail & LOGGER_RING_MASK_], (uint16_t)len))
+        {
+            logger_tx_busy_ = 0;
+        }
+        return;
+    }
+}
+
+/* The format is fixed per site, so the arguments tell messages apart */
+static uint32_t logger_hash_(const uint32_t* args, uint32_t qty)
+{
+    uint32_t hash = LOGGER_HASH_INI_ ^ qty;
+
+    while (0 < qty--)
+    {
+        hash = (hash ^ *args++) * LOGGER_HASH_PRIME_;
+    }
+
+    return hash;
+}
+
+/* Summary of the site's last message, the count starts over */
+static void logger_logd_repeat_(logger_site_t* site, uint32_t now)
+{
+    LOGGER_LOGD(LOGGER_DEFERRED_REPEAT_FMT, (unsigned long)site->repeat, (unsigned long)(site->id & 0xFFFFul))
+
+    site->repeat = 0;
+    site->time = now;
+}
+
 /********************** external functions definition ************************/
 
-#if 1 == LOGGER_CONFIG_USE_SEMIHOSTING
-void logger_log_print_(char* const msg)
+/* Copy a whole message into the USART2 ring or drop it. Never blocks nor
+ * masks interrupts, safe from any interrupt priority */
+bool logger_uart_write(const char* data, uint32_t len)
+{
+    uint32_t head;
+    uint32_t index;
+    uint32_t first;
+    uint32_t drop;
+
+    if (!logger_ring_reserve_(len, &head))
+    {
+        do
+        {
+            drop = __LDREXW(&logger_drop_cnt);
+        } while (0 != __STREXW(drop + 1, &logger_drop_cnt));
+        return false;
+    }
+
+    index = head & LOGGER_RING_MASK_;
+    first = LOGGER_CONFIG_RING_SIZE - index;
+    if (first > len)
+    {
+        first = len;
+    }
+
+    memcpy(&logger_ring_[index], data, first);
+    memcpy(&logger_ring_[0], data + first, len - first);
+
+    logger_ring_commit_();
+
+    logger_tx_kick_();
+
+    return true;
+}
+
+/* Free bytes in the USART2 ring, for producers that would rather wait than
+ * have a message dropped. Others may take them in between */
+uint32_t logger_uart_room(void)
+{
+    return LOGGER_CONFIG_RING_SIZE - (logger_ring_head_ - logger_ring_tail_);
+}
+
+/* Whole record or nothing, one copy into the ring and no formatting */
+void logger_logd_(uint32_t id, const uint32_t* args, uint32_t qty)
+{
+    uint8_t record[LOGGER_DEFERRED_HEADER_LEN + (LOGGER_CONFIG_DEFERRED_MAX_ARGS * sizeof(uint32_t))];
+
+    if (LOGGER_CONFIG_DEFERRED_MAX_ARGS < qty)
+    {
+        qty = LOGGER_CONFIG_DEFERRED_MAX_ARGS;
+    }
+
+    record[0] = LOGGER_DEFERRED_SYNC;
+    record[1] = (uint8_t)qty;
+    record[2] = (uint8_t)id;
+    record[3] = (uint8_t)(id >> 8);
+    memcpy(&record[LOGGER_DEFERRED_HEADER_LEN], args, qty * sizeof(uint32_t));
+
+    logger_write((const char *)record, LOGGER_DEFERRED_HEADER_LEN + (qty * sizeof(uint32_t)));
+}
+
+/* A message identical to the last one sent from the site (same format and
+ * arguments) is only counted. The count goes out before the next different
+ * message, every period while the site keeps repeating, or from
+ * logger_update() once the site goes quiet. Thread mode only */
+void logger_logd_limit_(logger_site_t* site, uint32_t id, uint32_t period, const uint32_t* args, uint32_t qty)
+{
+    uint32_t hash = logger_hash_(args, qty);
+    uint32_t now = HAL_GetTick();
+
+    if (site->sent && (id == site->id) && (hash == site->hash))
+    {
+        site->repeat++;
+
+        if ((0 != period) && (period <= (now - site->time)))
+        {
+            logger_logd_repeat_(site, now);
+        }
+        return;
+    }
+
+    if (0 != site->repeat)
+    {
+        logger_logd_repeat_(site, now);
+    }
+
+    if (!site->sent)
+    {
+        site->next = logger_site_list_;
+        logger_site_list_ = site;
+        site->sent = true;
+    }
+
+    site->id = id;
+    site->hash = hash;
+    site->period = period;
+    site->time = now;
+
+    logger_logd_(id, args, qty);
+}
+
+/* Reports the counts left pending by the sites gone quiet. Call it from the
+ * main loop, thread mode like the sites themselves */
+void logger_update(void)
+{
+    logger_site_t* site;
+    uint32_t now = HAL_GetTick();
+    uint32_t period;
+
+    for (site = logger_site_list_; NULL != site; site = site->next)
+    {
+        period = (0 != site->period) ? site->period : LOGGER_CONFIG_REPEAT_PERIOD_MS;
+
+        if ((0 != site->repeat) && (period <= (now - site->time)))
+        {
+            logger_logd_repeat_(site, now);
+        }
+    }
+}
+
+/* Only lowers what the compile-time thresholds kept */
+void logger_set_level(uint32_t level)
+{
+    logger_level = level;
+}
+
+/* Raw bytes to the selected backend. ITM messages are written word by word,
+ * so interrupt handlers use their own stimulus port and never split a
+ * thread mode record */
+bool logger_write(const char* data, uint32_t len)
+{
+#if LOGGER_BACKEND_ITM == LOGGER_CONFIG_BACKEND
+    itm_trace_write((0 == __get_IPSR()) ? ITM_TRACE_PORT_LOG : ITM_TRACE_PORT_LOG_ISR, data, len);
+    return true;
+#elif LOGGER_BACKEND_UART == LOGGER_CONFIG_BACKEND
+    return logger_uart_write(data, len);
+#else
+    fwrite(data, 1, len, stdout);
+    fflush(stdout);
+    return true;
+#endif
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (USART2 != huart->Instance)
+    {
+        return;
+    }
+
+    logger_ring_tail_ += logger_tx_len_;
+    logger_tx_busy_ = 0;
+
+    logger_tx_kick_();
+}
+
+#if LOGGER_BACKEND_SEMIHOSTING == LOGGER_CONFIG_BACKEND
+void logger_log_print_(const char* msg, int len)
 {
 	printf(msg);
 	fflush(stdout);
 }
 #else
-void logger_log_print_(char* const msg)
+void logger_log_print_(const char* msg, int len)
 {
-    return;
+    if (0 >= len)
+    {
+        return;
+    }
+
+    if (LOGGER_CONFIG_MAXLEN <= len)
+    {
+        len = LOGGER_CONFIG_MAXLEN - 1;
+    }
+
+    logger_write(msg, (uint32_t)len);
 }
 #endif
 
@@ -0,0 +1,99 @@
+/*
+ * output_stage.c
+ *
+ */
+
+/********************** inclusions *******************************************/
+/* Project includes. */
+#include "main.h"
+
+/* Application & Tasks includes. */
+#include "output_stage.h"
+
+/********************** macros and definitions *******************************/
+#define OUTPUT_STAGE_PORT_STRIDE	(GPIOB_BASE - GPIOA_BASE)
+#define OUTPUT_STAGE_BSRR_RESET_POS	16ul
+
+/********************** internal data declaration ****************************/
+typedef struct
+{
+	uint32_t	shadow;		// Pin levels last written to the port
+	uint32_t	set;		// Pins requested high during this tick
+	uint32_t	reset;		// Pins requested low during this tick
+} output_stage_port_t;
+
+/********************** internal functions declaration ***********************/
+static uint32_t output_stage_index(GPIO_TypeDef *gpio_port);
+
+/********************** internal data definition *****************************/
+static output_stage_port_t output_stage_port[OUTPUT_STAGE_PORT_QTY];
+static uint32_t output_stage_dirty;		// Bit per port with pending requests
+
+/********************** external data declaration ****************************/
+
+/********************** internal functions definition ************************/
+static uint32_t output_stage_index(GPIO_TypeDef *gpio_port) {
+	return ((uint32_t)(uintptr_t)gpio_port - GPIOA_BASE) / OUTPUT_STAGE_PORT_STRIDE;
+}
+
+/********************** external functions definition ************************/
+/* Seed the shadows from the output registers left by MX_GPIO_Init. Once
+ * this runs, outputs must only be driven through the stage */
+void output_stage_init(void) {
+	GPIO_TypeDef *gpio_port;
+	uint32_t index;
+
+	for (index = 0; OUTPUT_STAGE_PORT_QTY > index; index++) {
+		gpio_port = (GPIO_TypeDef *)(GPIOA_BASE + (index * OUTPUT_STAGE_PORT_STRIDE));
+
+		output_stage_port[index].shadow = gpio_port->ODR & 0xFFFFul;
+		output_stage_port[index].set = 0ul;
+		output_stage_port[index].reset = 0ul;
+	}
+
+	output_stage_dirty = 0ul;
+}
+
+/* Only records the request, the last one of the tick wins */
+void output_stage_write(GPIO_TypeDef *gpio_port, uint16_t pin, GPIO_PinState state) {
+	uint32_t index = output_stage_index(gpio_port);
+	output_stage_port_t *p_port = &output_stage_port[index];
+
+	if (GPIO_PIN_RESET != state) {
+		p_port->set |= pin;
+		p_port->reset &= ~(uint32_t)pin;
+	}
+	else {
+		p_port->reset |= pin;
+		p_port->set &= ~(uint32_t)pin;
+	}
+
+	output_stage_dirty |= (1ul << index);
+}
+
+/* One BSRR write per port whose pins actually change, so all outputs of a
+ * port switch on the same bus cycle */
+void output_stage_flush(void) {
+	output_stage_port_t *p_port;
+	uint32_t bsrr;
+	uint32_t index;
+
+	while (0ul != output_stage_dirty) {
+		index = 31ul - (uint32_t)__CLZ(output_stage_dirty);
+		output_stage_dirty &= ~(1ul << index);
+		p_port = &output_stage_port[index];
+
+		bsrr = (p_port->set & ~p_port->shadow)
+				| ((p_port->reset & p_port->shadow) << OUTPUT_STAGE_BSRR_RESET_POS);
+
+		if (0ul != bsrr) {
+			((GPIO_TypeDef *)(GPIOA_BASE + (index * OUTPUT_STAGE_PORT_STRIDE)))->BSRR = bsrr;
+			p_port->shadow = (p_port->shadow | p_port->set) & ~p_port->reset;
+		}
+
+		p_port->set = 0ul;
+		p_port->reset = 0ul;
+	}
+}
+
+/********************** end of file ******************************************/
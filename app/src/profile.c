@@ -0,0 +1,98 @@
+/*
+ * profile.c
+ *
+ */
+
+/********************** inclusions *******************************************/
+/* Project includes. */
+#include "main.h"
+
+/* Demo includes. */
+#include "logger.h"
+
+/* Application & Tasks includes. */
+#include "profile.h"
+
+/********************** macros and definitions *******************************/
+#define PROFILE_MIN_INI		0xFFFFFFFFul
+
+/********************** internal data declaration ****************************/
+
+/********************** internal functions declaration ***********************/
+
+/********************** internal data definition *****************************/
+/* Indexed by profile_zone_t */
+static const char * const profile_zone_name[PROFILE_ZONE_QTY] = {
+	"sensor", "command", "normal", "setup", "actuator",
+	"cmd_parse", "cmd_execute", "nml_lane", "nml_plan", "setup_fsm",
+	"act_bar", "act_led", "act_flush"
+};
+
+/********************** external data declaration ****************************/
+profile_zone_dta_t profile_zone_dta_list[PROFILE_ZONE_QTY];
+
+/********************** internal functions definition ************************/
+
+/********************** external functions definition ************************/
+/* CYCCNT is started by timebase_init() and never reset afterwards */
+void profile_init(void) {
+	profile_reset();
+}
+
+/* Unsigned difference, right across one CYCCNT wrap (2^32 cycles, 67 s at
+ * 64 MHz) */
+void profile_zone_end(profile_zone_t zone, uint32_t cycle_counter) {
+	profile_zone_dta_t *p_zone_dta = &profile_zone_dta_list[zone];
+	uint32_t cycles = cycle_counter - p_zone_dta->start;
+
+	p_zone_dta->cnt++;
+	p_zone_dta->total += cycles;
+
+	if (p_zone_dta->min > cycles)
+		p_zone_dta->min = cycles;
+
+	if (p_zone_dta->max < cycles)
+		p_zone_dta->max = cycles;
+}
+
+void profile_reset(void) {
+	uint32_t zone;
+
+	for (zone = 0; PROFILE_ZONE_QTY > zone; zone++) {
+		profile_zone_dta_list[zone].cnt = 0ul;
+		profile_zone_dta_list[zone].total = 0ull;
+		profile_zone_dta_list[zone].min = PROFILE_MIN_INI;
+		profile_zone_dta_list[zone].max = 0ul;
+	}
+}
+
+/* A header, then one line per zone that ran: name, runs, min, avg & max
+ * cycles. One line per call, so the caller paces them to the UART:
+ * *p_cursor starts at 0, false once all are out */
+bool profile_dump(uint32_t *p_cursor) {
+	const profile_zone_dta_t *p_zone_dta;
+	uint32_t zone;
+
+	if (0ul == *p_cursor) {
+		(*p_cursor)++;
+		LOGGER_LOG("profile zone runs min avg max [cycles]\r\n");
+		return true;
+	}
+
+	while (PROFILE_ZONE_QTY >= *p_cursor) {
+		zone = *p_cursor - 1ul;
+		p_zone_dta = &profile_zone_dta_list[zone];
+		(*p_cursor)++;
+
+		if (0ul == p_zone_dta->cnt)
+			continue;
+
+		LOGGER_LOG("profile %s %lu %lu %lu %lu\r\n", profile_zone_name[zone], (unsigned long)p_zone_dta->cnt,
+				   (unsigned long)p_zone_dta->min, (unsigned long)(p_zone_dta->total / p_zone_dta->cnt), (unsigned long)p_zone_dta->max);
+		return true;
+	}
+
+	return false;
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,92 @@
+/*
+ * stack_monitor.c
+ *
+ */
+
+/********************** inclusions *******************************************/
+/* Project includes. */
+#include "main.h"
+
+/* Application & Tasks includes. */
+#include "stack_monitor.h"
+
+/********************** macros and definitions *******************************/
+/* Last of the 4 DWT comparators, debuggers take the first ones */
+#define STACK_MONITOR_DWT_FUNCTION_WRITE	0x6ul	// Watchpoint on data write
+#define STACK_MONITOR_DWT_MASK_WORD			2ul		// Ignore address bits [1:0]
+
+#define STACK_MONITOR_BOTTOM	((uint32_t *)((uintptr_t)_estack - (uintptr_t)&_Min_Stack_Size))
+#define STACK_MONITOR_GUARD_P	(STACK_MONITOR_BOTTOM + (STACK_MONITOR_GUARD / sizeof(uint32_t)))
+
+/********************** internal data declaration ****************************/
+extern uint32_t _estack[];
+extern uint32_t _Min_Stack_Size;	// Linker symbol, its address is the size
+
+/********************** internal functions declaration ***********************/
+
+/********************** internal data definition *****************************/
+static bool stack_monitor_reported;
+
+/********************** external data declaration ****************************/
+volatile uint32_t stack_monitor_trip_cnt;
+
+/********************** internal functions definition ************************/
+
+/********************** external functions definition ************************/
+/* Hardware trip: a DWT watchpoint on the guard word raises DebugMon on the
+ * first store, at no cost until then. With a debugger attached the core
+ * halts on that store instead */
+void stack_monitor_init(void) {
+	stack_monitor_reported = false;
+	stack_monitor_trip_cnt = 0ul;
+
+	if (4ul > ((DWT->CTRL & DWT_CTRL_NUMCOMP_Msk) >> DWT_CTRL_NUMCOMP_Pos))
+		return;
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk | CoreDebug_DEMCR_MON_EN_Msk;
+
+	DWT->COMP3 = (uint32_t)(uintptr_t)STACK_MONITOR_GUARD_P;
+	DWT->MASK3 = STACK_MONITOR_DWT_MASK_WORD;
+	DWT->FUNCTION3 = STACK_MONITOR_DWT_FUNCTION_WRITE;
+}
+
+/* From DebugMon_Handler: one trip is enough, the watchpoint goes off */
+void stack_monitor_trip(void) {
+	if (0ul == (DWT->FUNCTION3 & DWT_FUNCTION_MATCHED_Msk))
+		return;
+
+	DWT->FUNCTION3 = 0ul;
+	stack_monitor_trip_cnt++;
+}
+
+/* Every tick, also catches the guard overwritten without the watchpoint.
+ * True only the first time */
+bool stack_monitor_check(void) {
+	if (stack_monitor_reported)
+		return false;
+
+	if ((0ul == stack_monitor_trip_cnt) && (STACK_MONITOR_PAINT == *STACK_MONITOR_GUARD_P))
+		return false;
+
+	stack_monitor_reported = true;
+
+	return true;
+}
+
+/* High-water mark: the deepest word no longer painted. Scans the reserved
+ * stack from the bottom, on demand only. The whole size means the stack
+ * went past the reservation */
+uint32_t stack_monitor_used(void) {
+	const uint32_t *p_word = STACK_MONITOR_BOTTOM;
+
+	while ((p_word < _estack) && (STACK_MONITOR_PAINT == *p_word))
+		p_word++;
+
+	return (uint32_t)((uintptr_t)_estack - (uintptr_t)p_word);
+}
+
+uint32_t stack_monitor_size(void) {
+	return (uint32_t)(uintptr_t)&_Min_Stack_Size;
+}
+
+/********************** end of file ******************************************/
@@ -43,12 +43,17 @@
 /* Demo includes. */
 #include "logger.h"
 #include "dwt.h"
+#include "irq_stat.h"
+#include "profile.h"
 
 /* Application & Tasks includes. */
 #include "board.h"
 #include "app.h"
 #include "task_actuator_attribute.h"
 #include "task_actuator_interface.h"
+#include "task_normal_attribute.h"
+#include "led_timer.h"
+#include "output_stage.h"
 
 /********************** macros and definitions *******************************/
 #define G_TASK_ACT_CNT_INIT			0ul
@@ -58,21 +63,66 @@
 #define DEL_LED_XX_BLI				500ul
 #define DEL_LED_XX_MIN				0ul
 
+#define DEL_LED_BAR_SEGMENTS		4ul
+#define DEL_LED_BAR_SPEED_MAX		DEL_NML_MAX_SPEED
+
 /********************** internal data declaration ****************************/
 const task_actuator_cfg_t task_actuator_cfg_list[] = {
 	{ID_LED_A,  LED_A_PORT,  LED_A_PIN, LED_A_ON,  LED_A_OFF,
-	 DEL_LED_XX_BLI, DEL_LED_XX_PUL}
+	 DEL_LED_XX_BLI, DEL_LED_XX_PUL, LED_A_TIM, LED_A_TIM_CHANNEL},
+	{ID_LED_PACKS_0,  LED_PACKS_0_PORT,  LED_PACKS_0_PIN, LED_BAR_ON,  LED_BAR_OFF,
+	 DEL_LED_XX_BLI, DEL_LED_XX_PUL, NULL, 0ul},
+	{ID_LED_PACKS_1,  LED_PACKS_1_PORT,  LED_PACKS_1_PIN, LED_BAR_ON,  LED_BAR_OFF,
+	 DEL_LED_XX_BLI, DEL_LED_XX_PUL, NULL, 0ul},
+	{ID_LED_PACKS_2,  LED_PACKS_2_PORT,  LED_PACKS_2_PIN, LED_BAR_ON,  LED_BAR_OFF,
+	 DEL_LED_XX_BLI, DEL_LED_XX_PUL, NULL, 0ul},
+	{ID_LED_PACKS_3,  LED_PACKS_3_PORT,  LED_PACKS_3_PIN, LED_BAR_ON,  LED_BAR_OFF,
+	 DEL_LED_XX_BLI, DEL_LED_XX_PUL, NULL, 0ul},
+	{ID_LED_SPEED_0,  LED_SPEED_0_PORT,  LED_SPEED_0_PIN, LED_BAR_ON,  LED_BAR_OFF,
+	 DEL_LED_XX_BLI, DEL_LED_XX_PUL, NULL, 0ul},
+	{ID_LED_SPEED_1,  LED_SPEED_1_PORT,  LED_SPEED_1_PIN, LED_BAR_ON,  LED_BAR_OFF,
+	 DEL_LED_XX_BLI, DEL_LED_XX_PUL, NULL, 0ul},
+	{ID_LED_SPEED_2,  LED_SPEED_2_PORT,  LED_SPEED_2_PIN, LED_BAR_ON,  LED_BAR_OFF,
+	 DEL_LED_XX_BLI, DEL_LED_XX_PUL, NULL, 0ul},
+	{ID_LED_SPEED_3,  LED_SPEED_3_PORT,  LED_SPEED_3_PIN, LED_BAR_ON,  LED_BAR_OFF,
+	 DEL_LED_XX_BLI, DEL_LED_XX_PUL, NULL, 0ul}
 };
 
 #define ACTUATOR_CFG_QTY	(sizeof(task_actuator_cfg_list)/sizeof(task_actuator_cfg_t))
 
 task_actuator_dta_t task_actuator_dta_list[] = {
-	{DEL_LED_XX_MIN, ST_LED_XX_OFF, EV_LED_XX_NOT_BLINK, false}
+	{DEL_LED_XX_MIN, ST_LED_XX_OFF, EV_LED_XX_NOT_BLINK, false, NULL},
+	{DEL_LED_XX_MIN, ST_LED_XX_OFF, EV_LED_XX_NOT_BLINK, false, NULL},
+	{DEL_LED_XX_MIN, ST_LED_XX_OFF, EV_LED_XX_NOT_BLINK, false, NULL},
+	{DEL_LED_XX_MIN, ST_LED_XX_OFF, EV_LED_XX_NOT_BLINK, false, NULL},
+	{DEL_LED_XX_MIN, ST_LED_XX_OFF, EV_LED_XX_NOT_BLINK, false, NULL},
+	{DEL_LED_XX_MIN, ST_LED_XX_OFF, EV_LED_XX_NOT_BLINK, false, NULL},
+	{DEL_LED_XX_MIN, ST_LED_XX_OFF, EV_LED_XX_NOT_BLINK, false, NULL},
+	{DEL_LED_XX_MIN, ST_LED_XX_OFF, EV_LED_XX_NOT_BLINK, false, NULL},
+	{DEL_LED_XX_MIN, ST_LED_XX_OFF, EV_LED_XX_NOT_BLINK, false, NULL}
 };
 
 #define ACTUATOR_DTA_QTY	(sizeof(task_actuator_dta_list)/sizeof(task_actuator_dta_t))
 
+const task_actuator_bar_cfg_t task_actuator_bar_cfg_list[] = {
+	{ID_BAR_PACKS, BAR_SRC_QTY_PACKS, SYST_LANE_0, ID_LED_PACKS_0, DEL_LED_BAR_SEGMENTS, DEL_SYST_MAX_PACKS},
+	{ID_BAR_SPEED, BAR_SRC_SPEED,     SYST_LANE_0, ID_LED_SPEED_0, DEL_LED_BAR_SEGMENTS, DEL_LED_BAR_SPEED_MAX}
+};
+
+#define ACTUATOR_BAR_QTY	(sizeof(task_actuator_bar_cfg_list)/sizeof(task_actuator_bar_cfg_t))
+
+const uint32_t task_actuator_bar_qty = ACTUATOR_BAR_QTY;
+
+task_actuator_bar_dta_t task_actuator_bar_dta_list[] = {
+	{DEL_LED_XX_MIN, DEL_LED_XX_MIN, false},
+	{DEL_LED_XX_MIN, DEL_LED_XX_MIN, false}
+};
+
 /********************** internal functions declaration ***********************/
+static void task_actuator_led(const task_actuator_cfg_t *p_task_actuator_cfg, const task_actuator_dta_t *p_task_actuator_dta, bool b_on);
+static void task_actuator_blink(const task_actuator_cfg_t *p_task_actuator_cfg, task_actuator_dta_t *p_task_actuator_dta);
+static void task_actuator_pulse(const task_actuator_cfg_t *p_task_actuator_cfg, task_actuator_dta_t *p_task_actuator_dta);
+static void task_actuator_bar(const task_actuator_bar_cfg_t *p_task_actuator_bar_cfg, task_actuator_bar_dta_t *p_task_actuator_bar_dta);
 
 /********************** internal data definition *****************************/
 const char *p_task_actuator 		= "Task Actuator (Actuator Statechart)";
@@ -82,6 +132,82 @@ const char *p_task_actuator_ 		= "Non-Blocking & Update By Time Code";
 uint32_t g_task_actuator_cnt;
 volatile uint32_t g_task_actuator_tick_cnt;
 
+/********************** internal functions definition ************************/
+static void task_actuator_led(const task_actuator_cfg_t *p_task_actuator_cfg, const task_actuator_dta_t *p_task_actuator_dta, bool b_on)
+{
+	if (NULL != p_task_actuator_dta->tim)
+	{
+		led_timer_force(p_task_actuator_dta->tim, p_task_actuator_cfg->tim_channel, b_on);
+	}
+	else
+	{
+		output_stage_write(p_task_actuator_cfg->gpio_port, p_task_actuator_cfg->pin,
+						   b_on ? p_task_actuator_cfg->led_on : p_task_actuator_cfg->led_off);
+	}
+}
+
+/* LEDs on a timer channel blink & pulse in hardware, the tick is only used
+ * by the software fallback */
+static void task_actuator_blink(const task_actuator_cfg_t *p_task_actuator_cfg, task_actuator_dta_t *p_task_actuator_dta)
+{
+	p_task_actuator_dta->tick = p_task_actuator_cfg->tick_blink;
+
+	if (NULL != p_task_actuator_dta->tim)
+	{
+		led_timer_blink(p_task_actuator_dta->tim, p_task_actuator_cfg->tim_channel, p_task_actuator_cfg->tick_blink);
+	}
+	else
+	{
+		task_actuator_led(p_task_actuator_cfg, p_task_actuator_dta, true);
+	}
+}
+
+static void task_actuator_pulse(const task_actuator_cfg_t *p_task_actuator_cfg, task_actuator_dta_t *p_task_actuator_dta)
+{
+	p_task_actuator_dta->tick = p_task_actuator_cfg->tick_pulse;
+
+	if (NULL != p_task_actuator_dta->tim)
+	{
+		led_timer_pulse(p_task_actuator_dta->tim, p_task_actuator_cfg->tim_channel, p_task_actuator_cfg->tick_pulse);
+	}
+	else
+	{
+		task_actuator_led(p_task_actuator_cfg, p_task_actuator_dta, true);
+	}
+}
+
+/* Any non-zero value lights at least one segment. Only the segments between
+ * the old and the new level get an event */
+static void task_actuator_bar(const task_actuator_bar_cfg_t *p_task_actuator_bar_cfg, task_actuator_bar_dta_t *p_task_actuator_bar_dta)
+{
+	uint32_t level;
+	uint32_t segment;
+
+	p_task_actuator_bar_dta->flag = false;
+
+	if (p_task_actuator_bar_dta->value >= p_task_actuator_bar_cfg->full_scale)
+	{
+		level = p_task_actuator_bar_cfg->segment_qty;
+	}
+	else
+	{
+		level = ((p_task_actuator_bar_dta->value * p_task_actuator_bar_cfg->segment_qty)
+				 + p_task_actuator_bar_cfg->full_scale - 1ul) / p_task_actuator_bar_cfg->full_scale;
+	}
+
+	for (segment = p_task_actuator_bar_dta->level; level > segment; segment++)
+	{
+		put_event_task_actuator(EV_LED_XX_ON, p_task_actuator_bar_cfg->first_segment + segment);
+	}
+
+	for (segment = level; p_task_actuator_bar_dta->level > segment; segment++)
+	{
+		put_event_task_actuator(EV_LED_XX_OFF, p_task_actuator_bar_cfg->first_segment + segment);
+	}
+
+	p_task_actuator_bar_dta->level = level;
+}
+
 /********************** external functions definition ************************/
 void task_actuator_init(void *parameters)
 {
@@ -99,7 +225,7 @@ void task_actuator_init(void *parameters)
 	g_task_actuator_cnt = G_TASK_ACT_CNT_INIT;
 
 	/* Print out: Task execution counter */
-	LOGGER_LOG("   %s = %lu\r\n", GET_NAME(g_task_actuator_cnt), g_task_actuator_cnt);
+	LOGGER_LOG("   %s = %lu\r\n", GET_NAME(g_task_actuator_cnt), (unsigned long)g_task_actuator_cnt);
 
 	for (index = 0; ACTUATOR_DTA_QTY > index; index++)
 	{
@@ -108,20 +234,39 @@ void task_actuator_init(void *parameters)
 		p_task_actuator_dta = &task_actuator_dta_list[index];
 
 		/* Print out: Index & Task execution FSM */
-		LOGGER_LOG("   %s = %lu", GET_NAME(index), index);
+		LOGGER_LOG("   %s = %lu", GET_NAME(index), (unsigned long)index);
 
 		state = p_task_actuator_dta->state;
-		LOGGER_LOG("   %s = %lu", GET_NAME(state), (uint32_t)state);
+		LOGGER_LOG("   %s = %lu", GET_NAME(state), (unsigned long)state);
 
 		event = p_task_actuator_dta->event;
-		LOGGER_LOG("   %s = %lu", GET_NAME(event), (uint32_t)event);
+		LOGGER_LOG("   %s = %lu", GET_NAME(event), (unsigned long)event);
 
 		b_event = p_task_actuator_dta->flag;
 		LOGGER_LOG("   %s = %s\r\n", GET_NAME(b_event), (b_event ? "true" : "false"));
 
-		HAL_GPIO_WritePin(p_task_actuator_cfg->gpio_port, p_task_actuator_cfg->pin, p_task_actuator_cfg->led_off);
+		/* A timer another LED already drives is refused, this LED then
+		 * blinks & pulses by software */
+		p_task_actuator_dta->tim = NULL;
+
+		if (NULL != p_task_actuator_cfg->tim)
+		{
+			if (true == led_timer_init(p_task_actuator_cfg->tim, p_task_actuator_cfg->tim_channel, p_task_actuator_cfg->gpio_port,
+									   p_task_actuator_cfg->pin, (GPIO_PIN_SET == p_task_actuator_cfg->led_on)))
+			{
+				p_task_actuator_dta->tim = p_task_actuator_cfg->tim;
+			}
+			else
+			{
+				LOGGER_LOG("   %s %lu refused, software blink & pulse\r\n", GET_NAME(led_timer_init), (unsigned long)index);
+			}
+		}
+
+		task_actuator_led(p_task_actuator_cfg, p_task_actuator_dta, false);
 	}
 
+	output_stage_flush();
+
 	g_task_actuator_tick_cnt = G_TASK_ACT_TICK_CNT_INI;
 }
 
@@ -137,17 +282,20 @@ void task_actuator_update(void *parameters)
 
 	/* Protect shared resource (g_task_actuator_tick_cnt) */
 	__asm("CPSID i");	/* disable interrupts*/
+	IRQ_STAT_CS_BEGIN();
     if (G_TASK_ACT_TICK_CNT_INI < g_task_actuator_tick_cnt)
     {
     	g_task_actuator_tick_cnt--;
     	b_time_update_required = true;
     }
+    IRQ_STAT_CS_END(IRQ_STAT_SRC_CS_ACTUATOR);
     __asm("CPSIE i");	/* enable interrupts*/
 
     while (b_time_update_required)
     {
 		/* Protect shared resource (g_task_actuator_tick_cnt) */
 		__asm("CPSID i");	/* disable interrupts*/
+		IRQ_STAT_CS_BEGIN();
 		if (G_TASK_ACT_TICK_CNT_INI < g_task_actuator_tick_cnt)
 		{
 			g_task_actuator_tick_cnt--;
@@ -157,8 +305,23 @@ void task_actuator_update(void *parameters)
 		{
 			b_time_update_required = false;
 		}
+		IRQ_STAT_CS_END(IRQ_STAT_SRC_CS_ACTUATOR);
 		__asm("CPSIE i");	/* enable interrupts*/
 
+		/* Bar graphs first, so their segments switch in this same tick */
+		PROFILE_ZONE_BEGIN(PROFILE_ZONE_ACT_BAR);
+
+		for (index = 0; ACTUATOR_BAR_QTY > index; index++)
+		{
+			if (true == task_actuator_bar_dta_list[index].flag)
+			{
+				task_actuator_bar(&task_actuator_bar_cfg_list[index], &task_actuator_bar_dta_list[index]);
+			}
+		}
+
+		PROFILE_ZONE_END(PROFILE_ZONE_ACT_BAR);
+		PROFILE_ZONE_BEGIN(PROFILE_ZONE_ACT_LED);
+
     	for (index = 0; ACTUATOR_DTA_QTY > index; index++)
 		{
     		/* Update Task Actuator Configuration & Data Pointer */
@@ -172,10 +335,24 @@ void task_actuator_update(void *parameters)
 					if ((true == p_task_actuator_dta->flag) && (EV_LED_XX_ON == p_task_actuator_dta->event))
 					{
 						p_task_actuator_dta->flag = false;
-						HAL_GPIO_WritePin(p_task_actuator_cfg->gpio_port, p_task_actuator_cfg->pin, p_task_actuator_cfg->led_on);
+						task_actuator_led(p_task_actuator_cfg, p_task_actuator_dta, true);
 						p_task_actuator_dta->state = ST_LED_XX_ON;
 					}
 
+					if ((true == p_task_actuator_dta->flag) && (EV_LED_XX_BLINK == p_task_actuator_dta->event))
+					{
+						p_task_actuator_dta->flag = false;
+						task_actuator_blink(p_task_actuator_cfg, p_task_actuator_dta);
+						p_task_actuator_dta->state = ST_LED_XX_BLINK_ON;
+					}
+
+					if ((true == p_task_actuator_dta->flag) && (EV_LED_XX_PULSE == p_task_actuator_dta->event))
+					{
+						p_task_actuator_dta->flag = false;
+						task_actuator_pulse(p_task_actuator_cfg, p_task_actuator_dta);
+						p_task_actuator_dta->state = ST_LED_XX_PULSE;
+					}
+
 					break;
 
 				case ST_LED_XX_ON:
@@ -183,22 +360,95 @@ void task_actuator_update(void *parameters)
 					if ((true == p_task_actuator_dta->flag) && (EV_LED_XX_OFF == p_task_actuator_dta->event))
 					{
 						p_task_actuator_dta->flag = false;
-						HAL_GPIO_WritePin(p_task_actuator_cfg->gpio_port, p_task_actuator_cfg->pin, p_task_actuator_cfg->led_off);
+						task_actuator_led(p_task_actuator_cfg, p_task_actuator_dta, false);
 						p_task_actuator_dta->state = ST_LED_XX_OFF;
 					}
 
 					break;
 
 				case ST_LED_XX_BLINK_ON:
+				case ST_LED_XX_BLINK_OFF:
 
-					break;
+					if ((true == p_task_actuator_dta->flag)
+							&& ((EV_LED_XX_OFF == p_task_actuator_dta->event) || (EV_LED_XX_NOT_BLINK == p_task_actuator_dta->event)))
+					{
+						p_task_actuator_dta->flag = false;
+						task_actuator_led(p_task_actuator_cfg, p_task_actuator_dta, false);
+						p_task_actuator_dta->state = ST_LED_XX_OFF;
+					}
 
-				case ST_LED_XX_BLINK_OFF:
+					else if ((true == p_task_actuator_dta->flag) && (EV_LED_XX_ON == p_task_actuator_dta->event))
+					{
+						p_task_actuator_dta->flag = false;
+						task_actuator_led(p_task_actuator_cfg, p_task_actuator_dta, true);
+						p_task_actuator_dta->state = ST_LED_XX_ON;
+					}
+
+					/* Hardware blink: the timer toggles the pin, nothing to do */
+					else if (NULL != p_task_actuator_dta->tim)
+					{
+					}
+
+					else if (p_task_actuator_dta->tick > DEL_LED_XX_MIN)
+					{
+						p_task_actuator_dta->tick--;
+					}
+
+					else
+					{
+						p_task_actuator_dta->tick = p_task_actuator_cfg->tick_blink;
+
+						if (ST_LED_XX_BLINK_ON == p_task_actuator_dta->state)
+						{
+							task_actuator_led(p_task_actuator_cfg, p_task_actuator_dta, false);
+							p_task_actuator_dta->state = ST_LED_XX_BLINK_OFF;
+						}
+						else
+						{
+							task_actuator_led(p_task_actuator_cfg, p_task_actuator_dta, true);
+							p_task_actuator_dta->state = ST_LED_XX_BLINK_ON;
+						}
+					}
 
 					break;
 
 				case ST_LED_XX_PULSE:
 
+					if ((true == p_task_actuator_dta->flag) && (EV_LED_XX_OFF == p_task_actuator_dta->event))
+					{
+						p_task_actuator_dta->flag = false;
+						task_actuator_led(p_task_actuator_cfg, p_task_actuator_dta, false);
+						p_task_actuator_dta->state = ST_LED_XX_OFF;
+					}
+
+					else if ((true == p_task_actuator_dta->flag) && (EV_LED_XX_ON == p_task_actuator_dta->event))
+					{
+						p_task_actuator_dta->flag = false;
+						task_actuator_led(p_task_actuator_cfg, p_task_actuator_dta, true);
+						p_task_actuator_dta->state = ST_LED_XX_ON;
+					}
+
+					/* Hardware pulse: done once the one pulse counter stopped */
+					else if (NULL != p_task_actuator_dta->tim)
+					{
+						if (false == led_timer_busy(p_task_actuator_dta->tim))
+						{
+							task_actuator_led(p_task_actuator_cfg, p_task_actuator_dta, false);
+							p_task_actuator_dta->state = ST_LED_XX_OFF;
+						}
+					}
+
+					else if (p_task_actuator_dta->tick > DEL_LED_XX_MIN)
+					{
+						p_task_actuator_dta->tick--;
+					}
+
+					else
+					{
+						task_actuator_led(p_task_actuator_cfg, p_task_actuator_dta, false);
+						p_task_actuator_dta->state = ST_LED_XX_OFF;
+					}
+
 					break;
 
 				default:
@@ -206,6 +456,13 @@ void task_actuator_update(void *parameters)
 					break;
 			}
 		}
+
+		PROFILE_ZONE_END(PROFILE_ZONE_ACT_LED);
+
+		/* Every GPIO output changed during this tick switches at once */
+		PROFILE_ZONE_BEGIN(PROFILE_ZONE_ACT_FLUSH);
+		output_stage_flush();
+		PROFILE_ZONE_END(PROFILE_ZONE_ACT_FLUSH);
     }
 }
 
@@ -43,6 +43,7 @@
 /* Demo includes. */
 #include "logger.h"
 #include "dwt.h"
+#include "trace.h"
 
 /* Application & Tasks includes. */
 #include "board.h"
@@ -66,8 +67,34 @@ void put_event_task_actuator(task_actuator_ev_t event, task_actuator_id_t identi
 
 	p_task_actuator_dta = &task_actuator_dta_list[identifier];
 
+	TRACE_QUEUE_PUT(TRACE_QUEUE_ACTUATOR, identifier, event);
+
 	p_task_actuator_dta->event = event;
 	p_task_actuator_dta->flag = true;
 }
 
+/* Latch the value on every bar showing source for lane, only a change makes
+ * Task Actuator touch the segments */
+void put_value_task_actuator_bar(task_actuator_bar_src_t source, uint32_t lane, uint32_t value)
+{
+	uint32_t index;
+	task_actuator_bar_dta_t *p_task_actuator_bar_dta;
+
+	for (index = 0; task_actuator_bar_qty > index; index++)
+	{
+		if ((source != task_actuator_bar_cfg_list[index].source) || (lane != task_actuator_bar_cfg_list[index].lane))
+			continue;
+
+		p_task_actuator_bar_dta = &task_actuator_bar_dta_list[index];
+
+		if (value != p_task_actuator_bar_dta->value)
+		{
+			TRACE_QUEUE_PUT(TRACE_QUEUE_ACTUATOR_BAR, index, value);
+
+			p_task_actuator_bar_dta->value = value;
+			p_task_actuator_bar_dta->flag = true;
+		}
+	}
+}
+
 /********************** end of file ******************************************/
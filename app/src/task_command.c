@@ -0,0 +1,483 @@
+/*
+ * task_command.c
+ *
+ */
+
+/********************** inclusions *******************************************/
+/* Project includes. */
+#include "task_command_attribute.h"
+#include "task_setup_attribute.h"
+#include "task_setup_interface.h"
+#include "task_normal_attribute.h"
+#include "task_shared_params.h"
+#include "flash_eeprom.h"
+#include "main.h"
+#include "sysmem.h"
+
+/* Demo includes. */
+#include "logger.h"
+#include "dwt.h"
+#include "profile.h"
+#include "trace.h"
+#include "irq_stat.h"
+#include "stack_monitor.h"
+
+/* Application & Tasks includes. */
+#include "board.h"
+#include "app.h"
+#include "task_command.h"
+
+/********************** macros and definitions *******************************/
+#define G_TASK_CMD_CNT_INI			0ul
+#define G_TASK_CMD_TICK_CNT_INI		0ul
+
+#define CMD_CANDIDATES_ALL			((1ul << KW_CMD_QTY) - 1ul)
+#define CMD_REPLY_MAXLEN			48ul
+
+/* Setup events put by a key: lane, key, release */
+#define CMD_KEY_EVENT_QTY			3ul
+
+/* Free USART2 ring bytes a dump waits for: a log line and the final reply */
+#define CMD_DUMP_ROOM				((uint32_t)LOGGER_CONFIG_MAXLEN + CMD_REPLY_MAXLEN)
+
+/********************** internal data declaration ****************************/
+task_command_dta_t task_command_dta =
+	{0ul, 0ul, 0ul, 0ul, {KW_CMD_UNKNOWN}, {0ul}, ST_CMD_SPACE, KW_CMD_UNKNOWN, 0ul};
+
+/********************** internal functions declaration ***********************/
+static void task_command_rx_start(void);
+static void task_command_parse(task_command_dta_t *p_dta, uint8_t byte, task_shared_params_t *p_params_list);
+static void task_command_token_end(task_command_dta_t *p_dta);
+static void task_command_execute(task_command_dta_t *p_dta, task_shared_params_t *p_params_list);
+static void task_command_dump(task_command_dta_t *p_dta);
+static void task_command_reply(const char *p_fmt, uint32_t value_0, uint32_t value_1, uint32_t value_2, uint32_t value_3);
+
+/********************** internal data definition *****************************/
+const char *p_task_command 		= "Task Command (UART Channel)";
+const char *p_task_command_ 	= "Non-Blocking & Update By Time Code";
+
+/* Indexed by task_command_kw_t */
+static const char * const task_command_kw_list[KW_CMD_QTY] = {
+	"get", "set", "key", "pack_rate", "waiting_time", "counters", "enter", "next", "escape",
+	"log_level", "profile", "trace", "irq", "stack", "heap"
+};
+
+/* Written by DMA, parsed in place by the task */
+static uint8_t task_command_rx_buffer[CMD_RX_BUFFER_SIZE];
+
+/* Ring index past the last received byte, updated on DMA half/full transfer
+ * and on IDLE line */
+static volatile uint32_t task_command_rx_head;
+static volatile bool task_command_rx_restart;
+
+/********************** external data declaration ****************************/
+extern UART_HandleTypeDef huart2;
+
+uint32_t g_task_command_cnt;
+volatile uint32_t g_task_command_tick_cnt;
+
+/********************** internal functions definition ************************/
+static void task_command_rx_start(void) {
+	task_command_rx_head = 0ul;
+	HAL_UARTEx_ReceiveToIdle_DMA(&huart2, task_command_rx_buffer, (uint16_t)CMD_RX_BUFFER_SIZE);
+}
+
+/* Replies share the USART2 TX ring with the logger. The values go out as
+ * unsigned long, for the %lu / %lx of the formats */
+static void task_command_reply(const char *p_fmt, uint32_t value_0, uint32_t value_1, uint32_t value_2, uint32_t value_3) {
+	char reply[CMD_REPLY_MAXLEN];
+	int length;
+
+	length = snprintf(reply, CMD_REPLY_MAXLEN, p_fmt, (unsigned long)value_0, (unsigned long)value_1,
+					  (unsigned long)value_2, (unsigned long)value_3);
+
+	if (0 < length)
+		logger_uart_write(reply, ((uint32_t)length < CMD_REPLY_MAXLEN) ? (uint32_t)length : (CMD_REPLY_MAXLEN - 1ul));
+}
+
+/* Close the current token: a word keeps the keyword whose text ended exactly
+ * here, a number keeps its accumulated value */
+static void task_command_token_end(task_command_dta_t *p_dta) {
+	task_command_kw_t kw = KW_CMD_UNKNOWN;
+	uint32_t index;
+
+	if (ST_CMD_WORD == p_dta->state) {
+		for (index = 0; KW_CMD_QTY > index; index++) {
+			if ((p_dta->candidates & (1ul << index)) && ('\0' == task_command_kw_list[index][p_dta->length])) {
+				kw = (task_command_kw_t)index;
+				break;
+			}
+		}
+	}
+	else {
+		kw = KW_CMD_NUMBER;
+	}
+
+	p_dta->token[p_dta->token_qty] = kw;
+	p_dta->token_qty++;
+	p_dta->state = ST_CMD_SPACE;
+}
+
+static void task_command_parse(task_command_dta_t *p_dta, uint8_t byte, task_shared_params_t *p_params_list) {
+	bool b_blank = ((' ' == byte) || ('\t' == byte));
+	bool b_eol = (('\r' == byte) || ('\n' == byte));
+	uint32_t index;
+
+	if ((b_blank || b_eol) && ((ST_CMD_WORD == p_dta->state) || (ST_CMD_NUMBER == p_dta->state)))
+		task_command_token_end(p_dta);
+
+	if (b_eol) {
+		if ((ST_CMD_DISCARD == p_dta->state) || ((0ul < p_dta->token_qty) && (KW_CMD_UNKNOWN == p_dta->token[p_dta->token_qty - 1ul])))
+			task_command_reply("err\r\n", 0ul, 0ul, 0ul, 0ul);
+		else if (0ul < p_dta->token_qty) {
+			PROFILE_ZONE_BEGIN(PROFILE_ZONE_CMD_EXECUTE);
+			task_command_execute(p_dta, p_params_list);
+			PROFILE_ZONE_END(PROFILE_ZONE_CMD_EXECUTE);
+		}
+
+		p_dta->token_qty = 0ul;
+		p_dta->state = ST_CMD_SPACE;
+		return;
+	}
+
+	if (b_blank || (ST_CMD_DISCARD == p_dta->state))
+		return;
+
+	switch (p_dta->state) {
+
+		case ST_CMD_SPACE:
+
+			/* Unknown keywords or too many tokens void the whole line */
+			if ((CMD_TOKEN_QTY == p_dta->token_qty)
+					|| ((0ul < p_dta->token_qty) && (KW_CMD_UNKNOWN == p_dta->token[p_dta->token_qty - 1ul]))) {
+				p_dta->state = ST_CMD_DISCARD;
+				break;
+			}
+
+			p_dta->length = 0ul;
+
+			if (('0' <= byte) && ('9' >= byte)) {
+				p_dta->value[p_dta->token_qty] = 0ul;
+				p_dta->state = ST_CMD_NUMBER;
+			}
+			else {
+				p_dta->candidates = CMD_CANDIDATES_ALL;
+				p_dta->state = ST_CMD_WORD;
+			}
+
+			/* The first byte belongs to the token */
+			/* fall through */
+
+		case ST_CMD_WORD:
+
+			if (ST_CMD_WORD == p_dta->state) {
+				for (index = 0; KW_CMD_QTY > index; index++) {
+					if ((p_dta->candidates & (1ul << index)) && (byte != (uint8_t)task_command_kw_list[index][p_dta->length]))
+						p_dta->candidates &= ~(1ul << index);
+				}
+
+				p_dta->length++;
+
+				if (0ul == p_dta->candidates)
+					p_dta->state = ST_CMD_DISCARD;
+
+				break;
+			}
+
+			/* fall through */
+
+		case ST_CMD_NUMBER:
+
+			if (('0' > byte) || ('9' < byte) || (10ul < ++p_dta->length))
+				p_dta->state = ST_CMD_DISCARD;
+			else
+				p_dta->value[p_dta->token_qty] = (p_dta->value[p_dta->token_qty] * 10ul) + (uint32_t)(byte - '0');
+
+			break;
+
+		default:
+
+			break;
+	}
+}
+
+static void task_command_execute(task_command_dta_t *p_dta, task_shared_params_t *p_params_list) {
+	task_shared_params_dta_t shared_params_dta;
+	task_command_kw_t verb = p_dta->token[0];
+	task_command_kw_t item = (1ul < p_dta->token_qty) ? p_dta->token[1] : KW_CMD_UNKNOWN;
+	uint32_t lane_index = (KW_CMD_SET == verb) ? 3ul : 2ul;
+	uint32_t lane = SYST_LANE_0;
+	uint32_t value;
+	uint32_t index;
+
+	/* Optional trailing lane */
+	if (lane_index < p_dta->token_qty) {
+		if ((KW_CMD_NUMBER != p_dta->token[lane_index]) || (SYST_LANE_QTY <= p_dta->value[lane_index])) {
+			task_command_reply("err\r\n", 0ul, 0ul, 0ul, 0ul);
+			return;
+		}
+		lane = p_dta->value[lane_index];
+	}
+
+	switch (verb) {
+
+		case KW_CMD_GET:
+
+			snapshot_task_shared_params(&p_params_list[lane], &shared_params_dta);
+
+			if (KW_CMD_PACK_RATE == item)
+				task_command_reply("ok %lu\r\n", shared_params_dta.pack_rate, 0ul, 0ul, 0ul);
+			else if (KW_CMD_WAITING_TIME == item)
+				task_command_reply("ok %lu\r\n", shared_params_dta.waiting_time, 0ul, 0ul, 0ul);
+			else if (KW_CMD_COUNTERS == item)
+				task_command_reply("counters %lu %lu %lu %lu\r\n", lane, g_app_cnt,
+								   task_normal_dta.qty_packs[lane], task_normal_dta.speed[lane]);
+			else if (KW_CMD_LOG_LEVEL == item)
+				task_command_reply("ok %lu\r\n", logger_level, 0ul, 0ul, 0ul);
+			else if ((KW_CMD_PROFILE == item) || (KW_CMD_IRQ == item)) {
+				/* Long dumps go out from task_command_dump(), then "ok" */
+				p_dta->dump = item;
+				p_dta->dump_cursor = 0ul;
+			}
+			else if (KW_CMD_HEAP == item) {
+				for (index = 0; SYSMEM_SITE_QTY > index; index++) {
+					if (0ul != sysmem_site_list[index].cnt)
+						task_command_reply("heap_site 0x%08lx %lu %lu\r\n", sysmem_site_list[index].site,
+										   sysmem_site_list[index].cnt, sysmem_site_list[index].bytes, 0ul);
+				}
+				task_command_reply("heap %lu %lu %lu %lu\r\n", sysmem_stat.brk, sysmem_stat.brk_peak,
+								   sysmem_stat.alloc_cnt, sysmem_stat.late_cnt);
+			}
+			else if (KW_CMD_STACK == item)
+				task_command_reply("stack %lu %lu %lu\r\n", stack_monitor_used(), stack_monitor_size(), stack_monitor_trip_cnt, 0ul);
+			else
+				task_command_reply("err\r\n", 0ul, 0ul, 0ul, 0ul);
+
+			break;
+
+		case KW_CMD_SET:
+
+			if ((3ul > p_dta->token_qty) || (KW_CMD_NUMBER != p_dta->token[2])) {
+				task_command_reply("err\r\n", 0ul, 0ul, 0ul, 0ul);
+				break;
+			}
+
+			value = p_dta->value[2];
+
+			/* Any value clears the profiling zones or the interrupt stats */
+			if (KW_CMD_PROFILE == item) {
+				profile_reset();
+				task_command_reply("ok\r\n", 0ul, 0ul, 0ul, 0ul);
+				break;
+			}
+
+			if (KW_CMD_IRQ == item) {
+				irq_stat_reset();
+				task_command_reply("ok\r\n", 0ul, 0ul, 0ul, 0ul);
+				break;
+			}
+
+			/* 0 freezes the trace recorder for a debugger dump, 1 resumes */
+			if (KW_CMD_TRACE == item) {
+				trace_enable(0ul != value);
+				task_command_reply("ok\r\n", 0ul, 0ul, 0ul, 0ul);
+				break;
+			}
+
+			/* Runtime threshold, not persisted */
+			if (KW_CMD_LOG_LEVEL == item) {
+				if (LOGGER_LEVEL_TRACE < value) {
+					task_command_reply("err\r\n", 0ul, 0ul, 0ul, 0ul);
+					break;
+				}
+
+				logger_set_level(value);
+				task_command_reply("ok\r\n", 0ul, 0ul, 0ul, 0ul);
+				break;
+			}
+
+			snapshot_task_shared_params(&p_params_list[lane], &shared_params_dta);
+
+			/* Same ranges the setup menus cycle through */
+			if ((KW_CMD_PACK_RATE == item) && (DEL_SYST_MIN_PACK_RATE <= value) && (DEL_SYST_MAX_PACKS > value))
+				shared_params_dta.pack_rate = value;
+			else if ((KW_CMD_WAITING_TIME == item) && (DEL_SYST_MIN_WAITING_TIME <= value) && (DEL_SYST_MAX_WAITING_TIME > value))
+				shared_params_dta.waiting_time = value;
+			else {
+				task_command_reply("err\r\n", 0ul, 0ul, 0ul, 0ul);
+				break;
+			}
+
+			if ((false == publish_task_shared_params(&p_params_list[lane], &shared_params_dta))
+					|| (false == flash_eeprom_write(lane, &shared_params_dta)))
+				task_command_reply("err\r\n", 0ul, 0ul, 0ul, 0ul);
+			else
+				task_command_reply("ok\r\n", 0ul, 0ul, 0ul, 0ul);
+
+			break;
+
+		case KW_CMD_KEY:
+
+			/* Same event sequence a button press & release produces. Refused
+			 * for another lane while a menu is open, or without room for the
+			 * lane, key & release events */
+			if (((KW_CMD_ENTER != item) && (KW_CMD_NEXT != item) && (KW_CMD_ESCAPE != item))
+					|| ((ST_SETUP_NORMAL != task_setup_dta.state) && (lane != task_setup_dta.lane))
+					|| (CMD_KEY_EVENT_QTY > free_event_task_setup())) {
+				task_command_reply("err\r\n", 0ul, 0ul, 0ul, 0ul);
+				break;
+			}
+
+			put_lane_task_setup(lane);
+
+			if (KW_CMD_ENTER == item)
+				put_event_task_setup(EV_SETUP_ENTER);
+			else if (KW_CMD_NEXT == item)
+				put_event_task_setup(EV_SETUP_NEXT);
+			else
+				put_event_task_setup(EV_SETUP_ESCAPE);
+
+			put_event_task_setup(EV_SETUP_IDLE);
+			task_command_reply("ok\r\n", 0ul, 0ul, 0ul, 0ul);
+
+			break;
+
+		default:
+
+			task_command_reply("err\r\n", 0ul, 0ul, 0ul, 0ul);
+
+			break;
+	}
+}
+
+/* A line of the dump in progress, once the USART2 ring has room for it */
+static void task_command_dump(task_command_dta_t *p_dta) {
+	bool b_more;
+
+	if (CMD_DUMP_ROOM > logger_uart_room())
+		return;
+
+	if (KW_CMD_PROFILE == p_dta->dump)
+		b_more = profile_dump(&p_dta->dump_cursor);
+	else
+		b_more = irq_stat_dump(&p_dta->dump_cursor);
+
+	if (false == b_more) {
+		p_dta->dump = KW_CMD_UNKNOWN;
+		task_command_reply("ok\r\n", 0ul, 0ul, 0ul, 0ul);
+	}
+}
+
+/********************** external functions definition ************************/
+void task_command_init(void *parameters) {
+	task_command_dta_t *p_task_command_dta;
+	task_command_st_t state;
+
+	/* Print out: Task Initialized */
+	LOGGER_LOG("  %s is running - %s\r\n", GET_NAME(task_command_init), p_task_command);
+	LOGGER_LOG("  %s is a %s\r\n", GET_NAME(task_command), p_task_command_);
+
+	g_task_command_cnt = G_TASK_CMD_CNT_INI;
+
+	/* Print out: Task execution counter */
+	LOGGER_LOG("   %s = %lu\r\n", GET_NAME(g_task_command_cnt), (unsigned long)g_task_command_cnt);
+
+	/* Update Task Command Data Pointer */
+	p_task_command_dta = &task_command_dta;
+
+	/* Print out: Task execution FSM */
+	state = p_task_command_dta->state;
+	LOGGER_LOG("   %s = %lu\r\n", GET_NAME(state), (unsigned long)state);
+
+	task_command_rx_restart = false;
+	task_command_rx_start();
+
+	g_task_command_tick_cnt = G_TASK_CMD_TICK_CNT_INI;
+}
+
+void task_command_update(void *parameters) {
+	task_command_dta_t *p_task_command_dta;
+	task_shared_params_t *p_task_shared_params_list = (task_shared_params_t *)parameters;
+	bool b_time_update_required = false;
+	uint32_t head;
+
+	/* Update Task Command Counter */
+	g_task_command_cnt++;
+
+	/* Protect shared resource (g_task_command_tick_cnt) */
+	__asm("CPSID i");	/* disable interrupts*/
+	IRQ_STAT_CS_BEGIN();
+    if (G_TASK_CMD_TICK_CNT_INI < g_task_command_tick_cnt) {
+    	g_task_command_tick_cnt--;
+    	b_time_update_required = true;
+    }
+    IRQ_STAT_CS_END(IRQ_STAT_SRC_CS_COMMAND);
+    __asm("CPSIE i");	/* enable interrupts*/
+
+    while (b_time_update_required) {
+		/* Protect shared resource (g_task_command_tick_cnt) */
+		__asm("CPSID i");	/* disable interrupts*/
+		IRQ_STAT_CS_BEGIN();
+		if (G_TASK_CMD_TICK_CNT_INI < g_task_command_tick_cnt) {
+			g_task_command_tick_cnt--;
+			b_time_update_required = true;
+		}
+		else {
+			b_time_update_required = false;
+		}
+		IRQ_STAT_CS_END(IRQ_STAT_SRC_CS_COMMAND);
+		__asm("CPSIE i");	/* enable interrupts*/
+
+		/* Update Task Command Data Pointer */
+		p_task_command_dta = &task_command_dta;
+
+		/* Reception restarted after an error: the ring starts over and the
+		 * partial line is lost */
+		if (true == task_command_rx_restart) {
+			task_command_rx_restart = false;
+			p_task_command_dta->tail = 0ul;
+			p_task_command_dta->token_qty = 0ul;
+			p_task_command_dta->state = ST_CMD_DISCARD;
+		}
+
+		/* A dump goes out a line per tick and holds the next commands, their
+		 * bytes wait in the RX ring */
+		if (KW_CMD_UNKNOWN != p_task_command_dta->dump) {
+			PROFILE_ZONE_BEGIN(PROFILE_ZONE_CMD_EXECUTE);
+			task_command_dump(p_task_command_dta);
+			PROFILE_ZONE_END(PROFILE_ZONE_CMD_EXECUTE);
+			continue;
+		}
+
+		/* Parse every byte received since the last tick, in place, up to a
+		 * command that starts a dump */
+		head = task_command_rx_head;
+
+		while ((head != p_task_command_dta->tail) && (KW_CMD_UNKNOWN == p_task_command_dta->dump)) {
+			PROFILE_ZONE_BEGIN(PROFILE_ZONE_CMD_PARSE);
+			task_command_parse(p_task_command_dta, task_command_rx_buffer[p_task_command_dta->tail], p_task_shared_params_list);
+			p_task_command_dta->tail = (p_task_command_dta->tail + 1ul) & CMD_RX_BUFFER_MASK;
+			PROFILE_ZONE_END(PROFILE_ZONE_CMD_PARSE);
+		}
+    }
+}
+
+/* DMA half/full transfer or IDLE line: Size is the ring index past the last
+ * received byte */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+	if (USART2 != huart->Instance)
+		return;
+
+	task_command_rx_head = (uint32_t)Size & CMD_RX_BUFFER_MASK;
+}
+
+/* Noise, framing or overrun errors abort the DMA reception */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+	if (USART2 != huart->Instance)
+		return;
+
+	task_command_rx_restart = true;
+	task_command_rx_start();
+}
+
+/********************** end of file ******************************************/
@@ -42,12 +42,16 @@
 #include "task_normal_interface.h"
 #include "task_setup_attribute.h"
 #include "task_setup_interface.h"
+#include "flash_eeprom.h"
 #include "main.h"
 #include "string.h"
 
 /* Demo includes. */
+#define LOGGER_MODULE_LEVEL	LOGGER_CONFIG_LEVEL_TASK_NORMAL
 #include "logger.h"
 #include "dwt.h"
+#include "irq_stat.h"
+#include "profile.h"
 
 /* Application & Tasks includes. */
 #include "board.h"
@@ -61,37 +65,94 @@
 #define G_TASK_SYS_CNT_INI			0ul
 #define G_TASK_SYS_TICK_CNT_INI		0ul
 
-#define DEL_NML_MIN_SPEED          	1ul
-
 #define DEL_NML_DEF_SPEED			10ul
 #define DEL_NML_DEF_PACK_RATE		2ul
 #define DEL_NML_DEF_WAITING_TIME	5ul
 
-#define DEL_NML_MAX_SPEED			20ul
+/* Speed planner: flow trend in Q8 fixed point, updated with weight 1/8 per
+ * pack event, and qty_packs predicted 4 pack events ahead */
+#define DEL_NML_PLAN_Q_SHIFT		8ul
+#define DEL_NML_PLAN_FLOW_IN		((int32_t)(1l << DEL_NML_PLAN_Q_SHIFT))
+#define DEL_NML_PLAN_FLOW_OUT		(-DEL_NML_PLAN_FLOW_IN)
+#define DEL_NML_PLAN_TREND_SHIFT	3ul
+#define DEL_NML_PLAN_HORIZON_SHIFT	2ul
 
 /********************** internal data declaration ****************************/
-task_normal_dta_t task_normal_dta =
-	{DEL_SYST_MIN, DEL_SYST_MIN, DEL_SYST_MIN, ST_NML_IDLE, EV_NML_SYST_CTRL_OFF, false};
+task_normal_dta_t task_normal_dta;
 
-#define SYSTEM_DTA_QTY	(sizeof(task_normal_dta)/sizeof(task_normal_dta_t))
+#define SYSTEM_DTA_QTY	(sizeof(task_normal_dta.state)/sizeof(task_normal_st_t))
 
 /********************** internal functions declaration ***********************/
+static uint32_t task_normal_speed_step_mask(uint32_t pack_rate);
+static uint32_t task_normal_plan_speed(task_normal_dta_t *p_task_normal_dta, uint32_t lane, int32_t flow);
 
 /********************** internal data definition *****************************/
 const char *p_task_normal 		= "Task Normal (System Statechart)";
 const char *p_task_normal_ 		= "Non-Blocking & Update By Time Code";
 
+/* Target speed for each predicted qty_packs: full speed with an empty buffer,
+ * minimum speed once it is predicted to saturate */
+static uint32_t task_normal_speed_plan[DEL_SYST_MAX_PACKS + 1];
+
 /********************** external data declaration ****************************/
 uint32_t g_task_normal_cnt;
 volatile uint32_t g_task_normal_tick_cnt;
 
+/********************** internal functions definition ************************/
+/* Speed steps on every pack_rate-th pack: precompute which qty_packs values
+ * are multiples of pack_rate, so the event path needs no division. A zero
+ * pack_rate yields an empty mask (speed never steps) */
+static uint32_t task_normal_speed_step_mask(uint32_t pack_rate) {
+	uint32_t qty_packs;
+	uint32_t mask = 0;
+
+	if (DEL_SYST_MIN == pack_rate)
+		return mask;
+
+	for (qty_packs = DEL_SYST_MIN; DEL_SYST_MAX_PACKS >= qty_packs; qty_packs += pack_rate)
+		mask |= (1ul << qty_packs);
+
+	return mask;
+}
+
+/* Predictive speed planner, run once per pack event. Tracks the trend of
+ * arrivals vs departures, extrapolates qty_packs a few events ahead and
+ * picks the speed that keeps that prediction below DEL_SYST_MAX_PACKS.
+ * The trend goes negative while packs drain: it is scaled by multiply &
+ * divide, a left shift of a negative value is undefined.
+ * Returns the predicted qty_packs */
+static uint32_t task_normal_plan_speed(task_normal_dta_t *p_task_normal_dta, uint32_t lane, int32_t flow) {
+	int32_t qty_packs_pred;
+
+	PROFILE_ZONE_BEGIN(PROFILE_ZONE_NML_PLAN);
+
+	p_task_normal_dta->flow_trend[lane] += (flow - p_task_normal_dta->flow_trend[lane]) >> DEL_NML_PLAN_TREND_SHIFT;
+
+	qty_packs_pred = (int32_t)p_task_normal_dta->qty_packs[lane]
+				   + ((p_task_normal_dta->flow_trend[lane] * (int32_t)(1l << DEL_NML_PLAN_HORIZON_SHIFT))
+				   / (int32_t)(1l << DEL_NML_PLAN_Q_SHIFT));
+
+	if (qty_packs_pred < (int32_t)DEL_SYST_MIN)
+		qty_packs_pred = (int32_t)DEL_SYST_MIN;
+
+	if (qty_packs_pred > (int32_t)DEL_SYST_MAX_PACKS)
+		qty_packs_pred = (int32_t)DEL_SYST_MAX_PACKS;
+
+	p_task_normal_dta->target_speed[lane] = task_normal_speed_plan[qty_packs_pred];
+
+	PROFILE_ZONE_END(PROFILE_ZONE_NML_PLAN);
+
+	return (uint32_t)qty_packs_pred;
+}
+
 /********************** external functions definition ************************/
 void task_normal_init(void *parameters) {
+	uint32_t					lane;
+	uint32_t					qty_packs;
 	task_normal_dta_t 			*p_task_normal_dta;
 	task_normal_st_t			state;
 	task_normal_ev_t			event;
 	bool 						b_event;
-	task_shared_params_dta_t *p_task_shared_params_dta = (task_shared_params_dta_t *)parameters;
 
 	/* Print out: Task Initialized */
 	LOGGER_LOG("  %s is running - %s\r\n", GET_NAME(task_normal_init), p_task_normal);
@@ -100,22 +161,41 @@ void task_normal_init(void *parameters) {
 	g_task_normal_cnt = G_TASK_SYS_CNT_INI;
 
 	/* Print out: Task execution counter */
-	LOGGER_LOG("   %s = %lu\r\n", GET_NAME(g_task_normal_cnt), g_task_normal_cnt);
+	LOGGER_LOG("   %s = %lu\r\n", GET_NAME(g_task_normal_cnt), (unsigned long)g_task_normal_cnt);
 
 	init_queue_event_task_normal();
 
-	/* Update Task Actuator Configuration & Data Pointer */
+	for (qty_packs = DEL_SYST_MIN; DEL_SYST_MAX_PACKS >= qty_packs; qty_packs++)
+		task_normal_speed_plan[qty_packs] = DEL_NML_MAX_SPEED
+				- (((DEL_NML_MAX_SPEED - DEL_NML_MIN_SPEED) * qty_packs) / DEL_SYST_MAX_PACKS);
+
+	/* Update Task Normal Data Pointer */
 	p_task_normal_dta = &task_normal_dta;
 
-	/* Print out: Task execution FSM */
-	state = p_task_normal_dta->state;
-	LOGGER_LOG("   %s = %lu", GET_NAME(state), (uint32_t)state);
+	for (lane = 0; SYSTEM_DTA_QTY > lane; lane++) {
+		p_task_normal_dta->tick[lane] = DEL_SYST_MIN;
+		p_task_normal_dta->speed[lane] = DEL_SYST_MIN;
+		p_task_normal_dta->qty_packs[lane] = DEL_SYST_MIN;
+		p_task_normal_dta->pack_rate[lane] = DEL_SYST_MIN;
+		p_task_normal_dta->speed_step_mask[lane] = task_normal_speed_step_mask(DEL_SYST_MIN);
+		p_task_normal_dta->target_speed[lane] = DEL_SYST_MIN;
+		p_task_normal_dta->flow_trend[lane] = 0;
+		p_task_normal_dta->state[lane] = ST_NML_IDLE;
+		p_task_normal_dta->event[lane] = EV_NML_SYST_CTRL_OFF;
+		p_task_normal_dta->flag[lane] = false;
+
+		/* Print out: Lane & Task execution FSM */
+		LOGGER_LOG("   %s = %lu", GET_NAME(lane), (unsigned long)lane);
+
+		state = p_task_normal_dta->state[lane];
+		LOGGER_LOG("   %s = %lu", GET_NAME(state), (unsigned long)state);
 
-	event = p_task_normal_dta->event;
-	LOGGER_LOG("   %s = %lu", GET_NAME(event), (uint32_t)event);
+		event = p_task_normal_dta->event[lane];
+		LOGGER_LOG("   %s = %lu", GET_NAME(event), (unsigned long)event);
 
-	b_event = p_task_normal_dta->flag;
-	LOGGER_LOG("   %s = %s\r\n", GET_NAME(b_event), (b_event ? "true" : "false"));
+		b_event = p_task_normal_dta->flag[lane];
+		LOGGER_LOG("   %s = %s\r\n", GET_NAME(b_event), (b_event ? "true" : "false"));
+	}
 
 	g_task_normal_tick_cnt = G_TASK_SYS_TICK_CNT_INI;
 
@@ -123,24 +203,32 @@ void task_normal_init(void *parameters) {
 }
 
 void task_normal_update(void *parameters) {
+	uint32_t lane;
 	task_normal_dta_t *p_task_normal_dta;
 	bool b_time_update_required = false;
-	task_shared_params_dta_t *p_task_shared_params_dta = (task_shared_params_dta_t *)parameters;
+	task_shared_params_t *p_task_shared_params_list = (task_shared_params_t *)parameters;
+	task_shared_params_t *p_task_shared_params;
+	task_shared_params_dta_t shared_params_dta;
+	uint32_t speed_step;
+	uint32_t qty_packs_pred;
 
 	/* Update Task System Counter */
 	g_task_normal_cnt++;
 
 	/* Protect shared resource (g_task_normal_tick) */
 	__asm("CPSID i");	/* disable interrupts*/
+	IRQ_STAT_CS_BEGIN();
     if (G_TASK_SYS_TICK_CNT_INI < g_task_normal_tick_cnt) {
     	g_task_normal_tick_cnt--;
     	b_time_update_required = true;
     }
+    IRQ_STAT_CS_END(IRQ_STAT_SRC_CS_NORMAL);
     __asm("CPSIE i");	/* enable interrupts*/
 
     while (b_time_update_required) {
 		/* Protect shared resource (g_task_normal_tick) */
 		__asm("CPSID i");	/* disable interrupts*/
+		IRQ_STAT_CS_BEGIN();
 		if (G_TASK_SYS_TICK_CNT_INI < g_task_normal_tick_cnt) {
 			g_task_normal_tick_cnt--;
 			b_time_update_required = true;
@@ -148,114 +236,173 @@ void task_normal_update(void *parameters) {
 		else {
 			b_time_update_required = false;
 		}
+		IRQ_STAT_CS_END(IRQ_STAT_SRC_CS_NORMAL);
 		__asm("CPSIE i");	/* enable interrupts*/
 
     	/* Update Task System Data Pointer */
 		p_task_normal_dta = &task_normal_dta;
 
-		if (true == any_event_task_normal()) {
-			p_task_normal_dta->flag = true;
-			p_task_normal_dta->event = get_event_task_normal();
+		/* Fetch the next event of every lane */
+		for (lane = 0; SYSTEM_DTA_QTY > lane; lane++) {
+			if (true == any_event_task_normal(lane)) {
+				p_task_normal_dta->flag[lane] = true;
+				p_task_normal_dta->event[lane] = get_event_task_normal(lane);
+			}
 		}
 
-		switch (p_task_normal_dta->state) {
-
-			case ST_NML_IDLE:
-
-				if (EV_NML_SYST_CTRL_ON == p_task_normal_dta->event) {
-					LOGGER_LOG("ENTRE AL SISTEMA DE CONTROL");
-					p_task_normal_dta->state = ST_NML_SYST_CTRL;
-					p_task_normal_dta->qty_packs = DEL_SYST_MIN;
-					p_task_normal_dta->speed = DEL_NML_DEF_SPEED;
-					p_task_shared_params_dta->pack_rate = DEL_NML_DEF_PACK_RATE;
-					p_task_shared_params_dta->waiting_time = DEL_NML_DEF_WAITING_TIME;
-					p_task_normal_dta->tick = DEL_SYST_MIN;
-				}
-
-				if (EV_NML_SETUP_ON == p_task_normal_dta->event) {
-					LOGGER_LOG("ENTRE AL SETUP");
-					p_task_normal_dta->state = ST_NML_SETUP;
-					p_task_normal_dta->qty_packs = DEL_SYST_MIN;
-					p_task_normal_dta->speed = DEL_NML_DEF_SPEED;
-					p_task_shared_params_dta->pack_rate = DEL_NML_DEF_PACK_RATE;
-					p_task_shared_params_dta->waiting_time = DEL_NML_DEF_WAITING_TIME;
-					p_task_normal_dta->tick = DEL_SYST_MIN;
-					put_event_task_setup(EV_SETUP_ON);
-				}
-
-				break;
-
-			case ST_NML_SYST_CTRL:
-
-
-				/*if (p_task_normal_dta->qty_packs == DEL_SYST_MIN)
-					put_event_task_actuator(EV_LED_XX_TURN_ON, ID_LED_MIN_SPEED);
-
-				if (p_task_normal_dta->qty_packs == DEL_SYST_MAX_PACKS)
-					put_event_task_actuator(EV_LED_XX_TURN_ON, ID_LED_MAX_SPEED);*/
-
-				if (EV_NML_PACK_IN == p_task_normal_dta->event && p_task_normal_dta->qty_packs < DEL_SYST_MAX_PACKS) {
-					LOGGER_LOG("SUBE LA CANT PACKS SIN BAJAR VEL\n");
-					p_task_normal_dta->qty_packs++;
-				}
-
-				else if (EV_NML_PACK_IN == p_task_normal_dta->event && (p_task_normal_dta->qty_packs % p_task_shared_params_dta->pack_rate) == 0
-						&& p_task_normal_dta->speed > DEL_NML_MIN_SPEED && p_task_normal_dta->qty_packs < DEL_SYST_MAX_PACKS) {
-					LOGGER_LOG("SUBE LA CANT PACKS BAJANDO VEL\n");
-					p_task_normal_dta->speed--;
-					p_task_normal_dta->qty_packs++;
-				}
-
-				if (EV_NML_NO_PACKS == p_task_normal_dta->event && p_task_normal_dta->tick == p_task_shared_params_dta->waiting_time
-						&& p_task_normal_dta->qty_packs == DEL_SYST_MIN) {
-					LOGGER_LOG("NO HAY PACKS Y SE CUMPLIÓ EL TIEMPO DE ESPERA\n");
-					put_event_task_normal(EV_NML_SYST_CTRL_OFF);
-				}
-
-				else if (EV_NML_NO_PACKS == p_task_normal_dta->event && p_task_normal_dta->qty_packs == DEL_SYST_MIN) {
-					LOGGER_LOG("AUMENTA TIEMPO DE ESPERA SI NO HAY PACKS\n");
-					p_task_normal_dta->tick++;
-				}
-
-				if (EV_NML_PACK_OUT == p_task_normal_dta->event && p_task_normal_dta->qty_packs > DEL_SYST_MIN) {
-					LOGGER_LOG("BAJA LA CANT PACKS SIN SUBIR VEL\n");
-					p_task_normal_dta->qty_packs--;
-				}
-
-				else if (EV_NML_PACK_OUT == p_task_normal_dta->event && (p_task_normal_dta->qty_packs % p_task_shared_params_dta->pack_rate) == 0
-						&& p_task_normal_dta->speed < DEL_NML_MAX_SPEED && p_task_normal_dta->qty_packs > DEL_SYST_MIN) {
-					LOGGER_LOG("BAJA LA CANT PACKS SUBIENDO VEL\n");
-					p_task_normal_dta->speed++;
-					p_task_normal_dta->qty_packs--;
-				}
-
-				if (EV_NML_SETUP_ON == p_task_normal_dta->event) {
-					LOGGER_LOG("ESTOY EN EL SETUP\n");
-					p_task_normal_dta->state = ST_NML_SETUP;
-					put_event_task_setup(EV_SETUP_ON);
-				}
-
-				if (EV_NML_SYST_CTRL_OFF == p_task_normal_dta->event) {
-					LOGGER_LOG("SE APAGA EL SYST DE CONTROL\n");
-					p_task_normal_dta->state = ST_NML_IDLE;
-					p_task_normal_dta->qty_packs = DEL_SYST_MIN;
-					p_task_normal_dta->speed = DEL_SYST_MIN;
-					p_task_shared_params_dta->pack_rate = DEL_SYST_MIN;
-					p_task_shared_params_dta->waiting_time = DEL_SYST_MIN;
-					p_task_normal_dta->tick = DEL_SYST_MIN;
-				}
-
-				break;
-
-			case ST_NML_SETUP:
-
-				if (EV_NML_SETUP_OFF == p_task_normal_dta->event) {
-					LOGGER_LOG("SE APAGA EL SETUP\n");
-					p_task_normal_dta->state = ST_NML_SYST_CTRL;
-					put_event_task_setup(EV_SETUP_OFF);
-				}
-
-				break;
+		for (lane = 0; SYSTEM_DTA_QTY > lane; lane++) {
+			PROFILE_ZONE_BEGIN(PROFILE_ZONE_NML_LANE);
+
+			/* Update Task Shared Params Pointer & take a consistent copy */
+			p_task_shared_params = &p_task_shared_params_list[lane];
+			snapshot_task_shared_params(p_task_shared_params, &shared_params_dta);
+
+			/* Rebuild the speed step mask only when pack_rate has changed */
+			if (p_task_normal_dta->pack_rate[lane] != shared_params_dta.pack_rate) {
+				p_task_normal_dta->pack_rate[lane] = shared_params_dta.pack_rate;
+				p_task_normal_dta->speed_step_mask[lane] = task_normal_speed_step_mask(p_task_normal_dta->pack_rate[lane]);
+			}
+
+			switch (p_task_normal_dta->state[lane]) {
+
+				case ST_NML_IDLE:
+
+					if (EV_NML_SYST_CTRL_ON == p_task_normal_dta->event[lane]) {
+						LOGGER_INFO("ENTRE AL SISTEMA DE CONTROL");
+						p_task_normal_dta->state[lane] = ST_NML_SYST_CTRL;
+						p_task_normal_dta->qty_packs[lane] = DEL_SYST_MIN;
+						p_task_normal_dta->speed[lane] = DEL_NML_DEF_SPEED;
+						p_task_normal_dta->target_speed[lane] = DEL_NML_DEF_SPEED;
+						p_task_normal_dta->flow_trend[lane] = 0;
+						if (false == flash_eeprom_read(lane, &shared_params_dta)) {
+							shared_params_dta.pack_rate = DEL_NML_DEF_PACK_RATE;
+							shared_params_dta.waiting_time = DEL_NML_DEF_WAITING_TIME;
+						}
+						publish_task_shared_params(p_task_shared_params, &shared_params_dta);
+						p_task_normal_dta->tick[lane] = DEL_SYST_MIN;
+					}
+
+					/* Task Setup is asked for the lane, the lane only goes to
+					 * ST_NML_SETUP once Task Setup answers EV_NML_SETUP_ON */
+					if ((true == p_task_normal_dta->flag[lane]) && (EV_NML_SETUP_SW_ON == p_task_normal_dta->event[lane])) {
+						p_task_normal_dta->flag[lane] = false;
+						put_lane_task_setup(lane);
+						put_lane_event_task_setup(EV_SETUP_ON, lane);
+					}
+
+					if (EV_NML_SETUP_ON == p_task_normal_dta->event[lane]) {
+						LOGGER_INFO("ENTRE AL SETUP");
+						p_task_normal_dta->state[lane] = ST_NML_SETUP;
+						p_task_normal_dta->qty_packs[lane] = DEL_SYST_MIN;
+						p_task_normal_dta->speed[lane] = DEL_NML_DEF_SPEED;
+						p_task_normal_dta->target_speed[lane] = DEL_NML_DEF_SPEED;
+						p_task_normal_dta->flow_trend[lane] = 0;
+						if (false == flash_eeprom_read(lane, &shared_params_dta)) {
+							shared_params_dta.pack_rate = DEL_NML_DEF_PACK_RATE;
+							shared_params_dta.waiting_time = DEL_NML_DEF_WAITING_TIME;
+						}
+						publish_task_shared_params(p_task_shared_params, &shared_params_dta);
+						p_task_normal_dta->tick[lane] = DEL_SYST_MIN;
+					}
+
+					break;
+
+				case ST_NML_SYST_CTRL:
+
+					/* Pack events are consumed once: the speed is re-planned on
+					 * every pack_rate-th pack, or at once if the buffer is
+					 * predicted to saturate */
+					if ((true == p_task_normal_dta->flag[lane]) && (EV_NML_PACK_IN == p_task_normal_dta->event[lane])) {
+						p_task_normal_dta->flag[lane] = false;
+						speed_step = (p_task_normal_dta->speed_step_mask[lane] >> p_task_normal_dta->qty_packs[lane]) & 1ul;
+
+						if (p_task_normal_dta->qty_packs[lane] < DEL_SYST_MAX_PACKS) {
+							LOGGER_DEBUG("SUBE LA CANT PACKS\n");
+							p_task_normal_dta->qty_packs[lane]++;
+						}
+
+						qty_packs_pred = task_normal_plan_speed(p_task_normal_dta, lane, DEL_NML_PLAN_FLOW_IN);
+						speed_step |= (uint32_t)(DEL_SYST_MAX_PACKS <= qty_packs_pred);
+
+						if (0ul != speed_step)
+							p_task_normal_dta->speed[lane] = p_task_normal_dta->target_speed[lane];
+					}
+
+					if (EV_NML_NO_PACKS == p_task_normal_dta->event[lane] && p_task_normal_dta->tick[lane] == shared_params_dta.waiting_time
+							&& p_task_normal_dta->qty_packs[lane] == DEL_SYST_MIN) {
+						LOGGER_INFO("NO HAY PACKS Y SE CUMPLIÓ EL TIEMPO DE ESPERA\n");
+						put_event_task_normal(EV_NML_SYST_CTRL_OFF, lane);
+					}
+
+					else if (EV_NML_NO_PACKS == p_task_normal_dta->event[lane] && p_task_normal_dta->qty_packs[lane] == DEL_SYST_MIN) {
+						LOGGER_INFO_LIMIT(LOGGER_CONFIG_REPEAT_PERIOD_MS, "AUMENTA TIEMPO DE ESPERA SI NO HAY PACKS\n");
+						p_task_normal_dta->tick[lane]++;
+					}
+
+					if ((true == p_task_normal_dta->flag[lane]) && (EV_NML_PACK_OUT == p_task_normal_dta->event[lane])) {
+						p_task_normal_dta->flag[lane] = false;
+						speed_step = (p_task_normal_dta->speed_step_mask[lane] >> p_task_normal_dta->qty_packs[lane]) & 1ul;
+
+						if (p_task_normal_dta->qty_packs[lane] > DEL_SYST_MIN) {
+							LOGGER_DEBUG("BAJA LA CANT PACKS\n");
+							p_task_normal_dta->qty_packs[lane]--;
+						}
+
+						qty_packs_pred = task_normal_plan_speed(p_task_normal_dta, lane, DEL_NML_PLAN_FLOW_OUT);
+						speed_step |= (uint32_t)(DEL_SYST_MAX_PACKS <= qty_packs_pred);
+
+						if (0ul != speed_step)
+							p_task_normal_dta->speed[lane] = p_task_normal_dta->target_speed[lane];
+					}
+
+					if ((true == p_task_normal_dta->flag[lane]) && (EV_NML_SETUP_SW_ON == p_task_normal_dta->event[lane])) {
+						p_task_normal_dta->flag[lane] = false;
+						put_lane_task_setup(lane);
+						put_lane_event_task_setup(EV_SETUP_ON, lane);
+					}
+
+					if (EV_NML_SETUP_ON == p_task_normal_dta->event[lane]) {
+						LOGGER_INFO("ESTOY EN EL SETUP\n");
+						p_task_normal_dta->state[lane] = ST_NML_SETUP;
+					}
+
+					if (EV_NML_SYST_CTRL_OFF == p_task_normal_dta->event[lane]) {
+						LOGGER_INFO("SE APAGA EL SYST DE CONTROL\n");
+						p_task_normal_dta->state[lane] = ST_NML_IDLE;
+						p_task_normal_dta->qty_packs[lane] = DEL_SYST_MIN;
+						p_task_normal_dta->speed[lane] = DEL_SYST_MIN;
+						p_task_normal_dta->target_speed[lane] = DEL_SYST_MIN;
+						p_task_normal_dta->flow_trend[lane] = 0;
+						shared_params_dta.pack_rate = DEL_SYST_MIN;
+						shared_params_dta.waiting_time = DEL_SYST_MIN;
+						publish_task_shared_params(p_task_shared_params, &shared_params_dta);
+						p_task_normal_dta->tick[lane] = DEL_SYST_MIN;
+					}
+
+					break;
+
+				case ST_NML_SETUP:
+
+					/* Back to ST_NML_SYST_CTRL once Task Setup has saved the
+					 * params and answers EV_NML_SETUP_OFF */
+					if ((true == p_task_normal_dta->flag[lane]) && (EV_NML_SETUP_SW_OFF == p_task_normal_dta->event[lane])) {
+						p_task_normal_dta->flag[lane] = false;
+						put_lane_event_task_setup(EV_SETUP_OFF, lane);
+					}
+
+					if (EV_NML_SETUP_OFF == p_task_normal_dta->event[lane]) {
+						LOGGER_INFO("SE APAGA EL SETUP\n");
+						p_task_normal_dta->state[lane] = ST_NML_SYST_CTRL;
+					}
+
+					break;
+			}
+
+			/* Line status on the bar graphs, only changes reach the LEDs */
+			put_value_task_actuator_bar(BAR_SRC_QTY_PACKS, lane, p_task_normal_dta->qty_packs[lane]);
+			put_value_task_actuator_bar(BAR_SRC_SPEED, lane, p_task_normal_dta->speed[lane]);
+
+			PROFILE_ZONE_END(PROFILE_ZONE_NML_LANE);
 		}
     }
 }
@@ -45,6 +45,7 @@
 /* Demo includes. */
 #include "logger.h"
 #include "dwt.h"
+#include "trace.h"
 
 /* Application & Tasks includes. */
 #include "board.h"
@@ -67,46 +68,53 @@ struct
 	uint32_t	tail;
 	uint32_t	count;
 	task_normal_ev_t	queue[MAX_EVENTS];
-} queue_task_b;
+} queue_task_b[SYST_LANE_QTY];
 
 /********************** external data declaration ****************************/
 
 /********************** external functions definition ************************/
 
 void init_queue_event_task_normal(void) {
+	uint32_t lane;
 	uint32_t i;
 
-	queue_task_b.head = 0;
-	queue_task_b.tail = 0;
-	queue_task_b.count = 0;
+	for (lane = 0; SYST_LANE_QTY > lane; lane++) {
+		queue_task_b[lane].head = 0;
+		queue_task_b[lane].tail = 0;
+		queue_task_b[lane].count = 0;
 
-	for (i = 0; i < MAX_EVENTS; i++)
-		queue_task_b.queue[i] = EVENT_UNDEFINED;
+		for (i = 0; i < MAX_EVENTS; i++)
+			queue_task_b[lane].queue[i] = EVENT_UNDEFINED;
+	}
 }
 
-void put_event_task_normal(task_normal_ev_t event) {
-	queue_task_b.count++;
-	queue_task_b.queue[queue_task_b.head++] = event;
+void put_event_task_normal(task_normal_ev_t event, uint32_t lane) {
+	TRACE_QUEUE_PUT(TRACE_QUEUE_NORMAL, lane, event);
 
-	if (MAX_EVENTS == queue_task_b.head)
-		queue_task_b.head = 0;
+	queue_task_b[lane].count++;
+	queue_task_b[lane].queue[queue_task_b[lane].head++] = event;
+
+	if (MAX_EVENTS == queue_task_b[lane].head)
+		queue_task_b[lane].head = 0;
 }
 
-task_normal_ev_t get_event_task_normal(void) {
+task_normal_ev_t get_event_task_normal(uint32_t lane) {
 	task_normal_ev_t event;
 
-	queue_task_b.count--;
-	event = queue_task_b.queue[queue_task_b.tail];
-	queue_task_b.queue[queue_task_b.tail++] = EVENT_UNDEFINED;
+	queue_task_b[lane].count--;
+	event = queue_task_b[lane].queue[queue_task_b[lane].tail];
+	queue_task_b[lane].queue[queue_task_b[lane].tail++] = EVENT_UNDEFINED;
+
+	if (MAX_EVENTS == queue_task_b[lane].tail)
+		queue_task_b[lane].tail = 0;
 
-	if (MAX_EVENTS == queue_task_b.tail)
-		queue_task_b.tail = 0;
+	TRACE_QUEUE_GET(TRACE_QUEUE_NORMAL, lane, event);
 
 	return event;
 }
 
-bool any_event_task_normal(void) {
-  return (queue_task_b.head != queue_task_b.tail);
+bool any_event_task_normal(uint32_t lane) {
+  return (queue_task_b[lane].head != queue_task_b[lane].tail);
 }
 
 /********************** end of file ******************************************/
@@ -47,6 +47,7 @@
 /* Demo includes. */
 #include "logger.h"
 #include "dwt.h"
+#include "irq_stat.h"
 
 /* Application & Tasks includes. */
 #include "board.h"
@@ -62,23 +63,27 @@
 #define DEL_BTN_01_MAX				50ul
 
 /********************** internal data declaration ****************************/
+/* The board wires the inputs of lane 0 only. Each further lane of
+ * SYST_LANE_QTY needs its own rows here, on its own pins, with .lane set to
+ * it; until then it is driven only through Task Command, and
+ * task_sensor_init() reports it */
 const task_sensor_cfg_t task_sensor_cfg_list[] = {
 	{ID_BTN_PACK_IN,  BTN_PACK_IN_PORT,  BTN_PACK_IN_PIN,  BTN_PACK_IN_PRESSED, DEL_BTN_01_MAX,
-	 EV_NML_NO_PACK_IN,  EV_NML_PACK_IN},
+	 EV_NML_NO_PACK_IN,  EV_NML_PACK_IN,  SYST_LANE_0, DST_TASK_NORMAL},
 	{ID_BTN_PACK_OUT,  BTN_PACK_OUT_PORT,  BTN_PACK_OUT_PIN,  BTN_PACK_OUT_PRESSED, DEL_BTN_01_MAX,
-	 EV_NML_NO_PACK_OUT,  EV_NML_PACK_OUT},
+	 EV_NML_NO_PACK_OUT,  EV_NML_PACK_OUT,  SYST_LANE_0, DST_TASK_NORMAL},
 	{ID_DIP_NORMAL_OR_SETUP,  DIP_NORMAL_OR_SETUP_PORT,  DIP_NORMAL_OR_SETUP_PIN,  DIP_NORMAL_OR_SETUP_PRESSED, DEL_BTN_01_MAX,
-	 EV_NML_SETUP_OFF,  EV_NML_SETUP_ON},
+	 EV_NML_SETUP_SW_OFF,  EV_NML_SETUP_SW_ON,  SYST_LANE_0, DST_TASK_NORMAL},
 	{ID_DIP_INFRARED,  DIP_INFRARED_PORT,  DIP_INFRARED_PIN,  DIP_INFRARED_PRESSED, DEL_BTN_01_MAX,
-	 EV_NML_PACKS,  EV_NML_NO_PACKS},
+	 EV_NML_PACKS,  EV_NML_NO_PACKS,  SYST_LANE_0, DST_TASK_NORMAL},
 	{ID_DIP_CTRL_SYST_ON,  DIP_CTRL_SYST_PORT,  DIP_CTRL_SYST_PIN,  DIP_CTRL_SYST_PRESSED, DEL_BTN_01_MAX,
-	 EV_NML_SYST_CTRL_OFF,  EV_NML_SYST_CTRL_ON},
+	 EV_NML_SYST_CTRL_OFF,  EV_NML_SYST_CTRL_ON,  SYST_LANE_0, DST_TASK_NORMAL},
 	{ID_BTN_ENTER,  BTN_SETUP_ENTER_PORT,  BTN_SETUP_ENTER_PIN,  BTN_SETUP_ENTER_PRESSED, DEL_BTN_01_MAX,
-	 EV_SETUP_IDLE,  EV_SETUP_ENTER},
+	 EV_SETUP_IDLE,  EV_SETUP_ENTER,  SYST_LANE_0, DST_TASK_SETUP},
 	{ID_BTN_NEXT,  BTN_SETUP_NEXT_PORT,  BTN_SETUP_NEXT_PIN,  BTN_SETUP_NEXT_PRESSED, DEL_BTN_01_MAX,
-	 EV_SETUP_IDLE,  EV_SETUP_NEXT},
+	 EV_SETUP_IDLE,  EV_SETUP_NEXT,  SYST_LANE_0, DST_TASK_SETUP},
 	{ID_BTN_ESCAPE,  BTN_SETUP_ESCAPE_PORT,  BTN_SETUP_ESCAPE_PIN,  BTN_SETUP_ESCAPE_PRESSED, DEL_BTN_01_MAX,
-     EV_SETUP_IDLE,  EV_SETUP_ESCAPE}
+     EV_SETUP_IDLE,  EV_SETUP_ESCAPE, SYST_LANE_0, DST_TASK_SETUP}
 };
 
 #define SENSOR_CFG_QTY	(sizeof(task_sensor_cfg_list)/sizeof(task_sensor_cfg_t))
@@ -110,6 +115,7 @@ volatile uint32_t g_task_sensor_tick_cnt;
 void task_sensor_init(void *parameters)
 {
 	uint32_t index;
+	uint32_t lane;
 	task_sensor_dta_t *p_task_sensor_dta;
 	task_sensor_st_t state;
 	task_sensor_ev_t event;
@@ -121,7 +127,7 @@ void task_sensor_init(void *parameters)
 	g_task_sensor_cnt = G_TASK_SEN_CNT_INIT;
 
 	/* Print out: Task execution counter */
-	LOGGER_LOG("   %s = %lu\r\n", GET_NAME(g_task_sensor_cnt), g_task_sensor_cnt);
+	LOGGER_LOG("   %s = %lu\r\n", GET_NAME(g_task_sensor_cnt), (unsigned long)g_task_sensor_cnt);
 
 	for (index = 0; SENSOR_DTA_QTY > index; index++)
 	{
@@ -129,14 +135,24 @@ void task_sensor_init(void *parameters)
 		p_task_sensor_dta = &task_sensor_dta_list[index];
 
 		/* Print out: Index & Task execution FSM */
-		LOGGER_LOG("   %s = %lu", GET_NAME(index), index);
+		LOGGER_LOG("   %s = %lu", GET_NAME(index), (unsigned long)index);
 
 		state = p_task_sensor_dta->state;
-		LOGGER_LOG("   %s = %lu", GET_NAME(state), (uint32_t)state);
+		LOGGER_LOG("   %s = %lu", GET_NAME(state), (unsigned long)state);
 
 		event = p_task_sensor_dta->event;
-		LOGGER_LOG("   %s = %lu\r\n", GET_NAME(event), (uint32_t)event);
+		LOGGER_LOG("   %s = %lu\r\n", GET_NAME(event), (unsigned long)event);
 	}
+
+	/* Lanes no sensor is configured for */
+	for (lane = 0; SYST_LANE_QTY > lane; lane++) {
+		for (index = 0; (SENSOR_CFG_QTY > index) && (lane != task_sensor_cfg_list[index].lane); index++)
+			;
+
+		if (SENSOR_CFG_QTY == index)
+			LOGGER_WARN("LANE %lu SIN SENSORES EN task_sensor_cfg_list\n", (unsigned long)lane);
+	}
+
 	g_task_sensor_tick_cnt = G_TASK_SEN_TICK_CNT_INI;
 }
 
@@ -152,17 +168,20 @@ void task_sensor_update(void *parameters)
 
 	/* Protect shared resource (g_task_sensor_tick_cnt) */
 	__asm("CPSID i");	/* disable interrupts*/
+	IRQ_STAT_CS_BEGIN();
     if (G_TASK_SEN_TICK_CNT_INI < g_task_sensor_tick_cnt)
     {
     	g_task_sensor_tick_cnt--;
     	b_time_update_required = true;
     }
+    IRQ_STAT_CS_END(IRQ_STAT_SRC_CS_SENSOR);
     __asm("CPSIE i");	/* enable interrupts*/
 
     while (b_time_update_required)
     {
 		/* Protect shared resource (g_task_sensor_tick_cnt) */
 		__asm("CPSID i");	/* disable interrupts*/
+		IRQ_STAT_CS_BEGIN();
 		if (G_TASK_SEN_TICK_CNT_INI < g_task_sensor_tick_cnt)
 		{
 			g_task_sensor_tick_cnt--;
@@ -172,6 +191,7 @@ void task_sensor_update(void *parameters)
 		{
 			b_time_update_required = false;
 		}
+		IRQ_STAT_CS_END(IRQ_STAT_SRC_CS_SENSOR);
 		__asm("CPSIE i");	/* enable interrupts*/
 
     	for (index = 0; SENSOR_DTA_QTY > index; index++)
@@ -212,8 +232,10 @@ void task_sensor_update(void *parameters)
 
 						else
 						{
-							put_event_task_normal(p_task_sensor_cfg->signal_down);
-							put_event_task_setup(p_task_sensor_cfg->signal_down);
+							if (DST_TASK_SETUP == p_task_sensor_cfg->destination)
+								put_event_task_setup(p_task_sensor_cfg->signal_down);
+							else
+								put_event_task_normal(p_task_sensor_cfg->signal_down, p_task_sensor_cfg->lane);
 							p_task_sensor_dta->state = ST_BTN_01_DOWN;
 						}
 					}
@@ -247,8 +269,10 @@ void task_sensor_update(void *parameters)
 
 						else
 						{
-							put_event_task_normal(p_task_sensor_cfg->signal_up);
-							put_event_task_setup(p_task_sensor_cfg->signal_up);
+							if (DST_TASK_SETUP == p_task_sensor_cfg->destination)
+								put_event_task_setup(p_task_sensor_cfg->signal_up);
+							else
+								put_event_task_normal(p_task_sensor_cfg->signal_up, p_task_sensor_cfg->lane);
 							p_task_sensor_dta->state = ST_BTN_01_UP;
 						}
 					}
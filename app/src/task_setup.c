@@ -42,12 +42,16 @@
 #include "task_setup_interface.h"
 #include "task_normal_attribute.h"
 #include "task_normal_interface.h"
+#include "flash_eeprom.h"
 #include "main.h"
 #include "string.h"
 
 /* Demo includes. */
+#define LOGGER_MODULE_LEVEL	LOGGER_CONFIG_LEVEL_TASK_SETUP
 #include "logger.h"
 #include "dwt.h"
+#include "irq_stat.h"
+#include "profile.h"
 
 /* Application & Tasks includes. */
 #include "board.h"
@@ -65,7 +69,7 @@
 
 /********************** internal data declaration ****************************/
 task_setup_dta_t task_setup_dta =
-	{DEL_SYST_MIN, ST_SETUP_INIT_MENU, EV_SETUP_IDLE, false};
+	{DEL_SYST_MIN, ST_SETUP_NORMAL, EV_SETUP_IDLE, false, SYST_LANE_0};
 
 #define SETUP_DTA_QTY	(sizeof(task_setup_dta)/sizeof(task_setup_dta_t))
 
@@ -85,7 +89,6 @@ void task_setup_init(void *parameters) {
 	task_setup_st_t			state;
 	task_setup_ev_t			event;
 	bool 					b_event;
-	task_shared_params_dta_t *p_task_shared_params_dta = (task_shared_params_dta_t *)parameters;
 
 
 	/* Print out: Task Initialized */
@@ -95,22 +98,29 @@ void task_setup_init(void *parameters) {
 	g_task_setup_cnt = G_TASK_SYS_CNT_INI;
 
 	/* Print out: Task execution counter */
-	LOGGER_LOG("   %s = %lu\r\n", GET_NAME(g_task_setup_cnt), g_task_setup_cnt);
+	LOGGER_LOG("   %s = %lu\r\n", GET_NAME(g_task_setup_cnt), (unsigned long)g_task_setup_cnt);
 
 	init_queue_event_task_setup();
 
 	/* Update Task Actuator Configuration & Data Pointer */
 	p_task_setup_dta = &task_setup_dta;
 
+	/* Out of the menus, on lane 0 */
+	p_task_setup_dta->option = DEL_SYST_MIN;
+	p_task_setup_dta->state = ST_SETUP_NORMAL;
+	p_task_setup_dta->event = EV_SETUP_IDLE;
+	p_task_setup_dta->flag = false;
+	p_task_setup_dta->lane = SYST_LANE_0;
+
 	/* Print out: Task execution FSM */
 	state = p_task_setup_dta->state;
-	LOGGER_LOG("   %s = %lu", GET_NAME(state), (uint32_t)state);
+	LOGGER_LOG("   %s = %lu", GET_NAME(state), (unsigned long)state);
 
 	state = p_task_setup_dta->state;
-	LOGGER_LOG("   %s = %lu", GET_NAME(state), (uint32_t)state);
+	LOGGER_LOG("   %s = %lu", GET_NAME(state), (unsigned long)state);
 
 	event = p_task_setup_dta->event;
-	LOGGER_LOG("   %s = %lu", GET_NAME(event), (uint32_t)event);
+	LOGGER_LOG("   %s = %lu", GET_NAME(event), (unsigned long)event);
 
 	b_event = p_task_setup_dta->flag;
 	LOGGER_LOG("   %s = %s\r\n", GET_NAME(b_event), (b_event ? "true" : "false"));
@@ -123,22 +133,28 @@ void task_setup_init(void *parameters) {
 void task_setup_update(void *parameters) {
 	task_setup_dta_t *p_task_setup_dta;
 	bool b_time_update_required = false;
-	task_shared_params_dta_t *p_task_shared_params_dta = (task_shared_params_dta_t *)parameters;
+	task_shared_params_t *p_task_shared_params_list = (task_shared_params_t *)parameters;
+	task_shared_params_t *p_task_shared_params;
+	task_shared_params_dta_t shared_params_dta;
+	uint32_t lane;
 
 	/* Update Task System Counter */
 	g_task_setup_cnt++;
 
 	/* Protect shared resource (g_task_setup_tick) */
 	__asm("CPSID i");	/* disable interrupts*/
+	IRQ_STAT_CS_BEGIN();
     if (G_TASK_SYS_TICK_CNT_INI < g_task_setup_tick_cnt) {
     	g_task_setup_tick_cnt--;
     	b_time_update_required = true;
     }
+    IRQ_STAT_CS_END(IRQ_STAT_SRC_CS_SETUP);
     __asm("CPSIE i");	/* enable interrupts*/
 
     while (b_time_update_required) {
 		/* Protect shared resource (g_task_setup_tick) */
 		__asm("CPSID i");	/* disable interrupts*/
+		IRQ_STAT_CS_BEGIN();
 		if (G_TASK_SYS_TICK_CNT_INI < g_task_setup_tick_cnt) {
 			g_task_setup_tick_cnt--;
 			b_time_update_required = true;
@@ -146,6 +162,7 @@ void task_setup_update(void *parameters) {
 		else {
 			b_time_update_required = false;
 		}
+		IRQ_STAT_CS_END(IRQ_STAT_SRC_CS_SETUP);
 		__asm("CPSIE i");	/* enable interrupts*/
 
     	/* Update Task System Data Pointer */
@@ -153,97 +170,155 @@ void task_setup_update(void *parameters) {
 
 		if (true == any_event_task_setup()) {
 			p_task_setup_dta->flag = true;
-			p_task_setup_dta->event = get_event_task_setup();
+			p_task_setup_dta->event = get_event_task_setup(&lane);
+
+			/* The lane is only switched out of the menus, never under them */
+			if (EV_SETUP_LANE == p_task_setup_dta->event) {
+				if (ST_SETUP_NORMAL == p_task_setup_dta->state)
+					p_task_setup_dta->lane = lane;
+				else if (lane != p_task_setup_dta->lane)
+					LOGGER_WARN("LANE %lu IGNORADO, SETUP EN LANE %lu\n", (unsigned long)lane, (unsigned long)p_task_setup_dta->lane);
+			}
+
+			/* Only the lane being set up turns the setup on or off */
+			if (((EV_SETUP_ON == p_task_setup_dta->event) || (EV_SETUP_OFF == p_task_setup_dta->event))
+					&& (lane != p_task_setup_dta->lane)) {
+				LOGGER_WARN("EVENTO %lu DEL LANE %lu IGNORADO, SETUP EN LANE %lu\n", (unsigned long)p_task_setup_dta->event,
+						(unsigned long)lane, (unsigned long)p_task_setup_dta->lane);
+				p_task_setup_dta->event = EV_SETUP_IDLE;
+			}
+		}
+
+		/* Each event acts once: a key held down is not taken again every
+		 * tick until its release */
+		else {
+			p_task_setup_dta->flag = false;
+			p_task_setup_dta->event = EV_SETUP_IDLE;
 		}
 
+		/* Update Task Shared Params Pointer (lane being set up) & take a consistent copy */
+		p_task_shared_params = &p_task_shared_params_list[p_task_setup_dta->lane];
+		snapshot_task_shared_params(p_task_shared_params, &shared_params_dta);
+
+		PROFILE_ZONE_BEGIN(PROFILE_ZONE_SETUP_FSM);
+
 		switch (p_task_setup_dta->state) {
 
 			case ST_SETUP_INIT_MENU:
 
-				LOGGER_LOG("ESTOY EN EL MENU INICIAL DEL SETUP\n");
+				LOGGER_INFO_LIMIT(LOGGER_CONFIG_REPEAT_PERIOD_MS, "ESTOY EN EL MENU INICIAL DEL SETUP\n");
 
 				if (EV_SETUP_NEXT == p_task_setup_dta->event && p_task_setup_dta->option == DEL_SETUP_DEF_OPTION) {
-					LOGGER_LOG("OPCION 2 INIT MENU\n");
+					LOGGER_DEBUG("OPCION 2 INIT MENU\n");
 					p_task_setup_dta->option = 2;
 				}
 
 				else if (EV_SETUP_NEXT == p_task_setup_dta->event && p_task_setup_dta->option == 2) {
-					LOGGER_LOG("OPCION 2 INIT MENU\n");
+					LOGGER_DEBUG("OPCION 2 INIT MENU\n");
 					p_task_setup_dta->option = DEL_SETUP_DEF_OPTION;
 				}
 
 				if (EV_SETUP_ENTER == p_task_setup_dta->event && p_task_setup_dta->option == 1) {
-					LOGGER_LOG("MENU PACKS LIM\n");
+					LOGGER_DEBUG("MENU PACKS LIM\n");
 					p_task_setup_dta->state = ST_SETUP_PACK_RATE_MENU;
 				}
 
 				else if (EV_SETUP_ENTER == p_task_setup_dta->event && p_task_setup_dta->option == 2) {
-					LOGGER_LOG("MENU WAITING TIME\n");
+					LOGGER_DEBUG("MENU WAITING TIME\n");
 					p_task_setup_dta->state = ST_SETUP_WAITING_TIME_MENU;
 				}
 
 				if (EV_SETUP_OFF == p_task_setup_dta->event) {
 					p_task_setup_dta->option = DEL_SYST_MIN;
-					LOGGER_LOG("APAGO EL SET UP\n");
-					put_event_task_normal(EV_NML_SETUP_OFF);
+					LOGGER_INFO("APAGO EL SET UP\n");
+					flash_eeprom_write(p_task_setup_dta->lane, &shared_params_dta);
+					put_event_task_normal(EV_NML_SETUP_OFF, p_task_setup_dta->lane);
+					p_task_setup_dta->state = ST_SETUP_NORMAL;
 				}
 
 				break;
 
 			case ST_SETUP_PACK_RATE_MENU:
 
-				LOGGER_LOG("ESTOY EN EL MENU DEL PACKS LIM \n");
+				LOGGER_INFO_LIMIT(LOGGER_CONFIG_REPEAT_PERIOD_MS, "ESTOY EN EL MENU DEL PACKS LIM \n");
 
-				if (EV_SETUP_NEXT == p_task_setup_dta->event && p_task_shared_params_dta->pack_rate < DEL_SYST_MAX_PACKS) {
-					p_task_shared_params_dta->pack_rate++;
-					LOGGER_LOG("VARIO EL PACK RATE %lu\n", p_task_shared_params_dta->pack_rate);
+				if (EV_SETUP_NEXT == p_task_setup_dta->event && shared_params_dta.pack_rate < DEL_SYST_MAX_PACKS) {
+					shared_params_dta.pack_rate++;
+					LOGGER_INFO("VARIO EL PACK RATE %lu\n", (unsigned long)shared_params_dta.pack_rate);
 				}
 
-				if (EV_SETUP_NEXT == p_task_setup_dta->event && p_task_shared_params_dta->pack_rate == DEL_SYST_MAX_PACKS) {
-					p_task_shared_params_dta->pack_rate = DEL_SYST_MIN_PACK_RATE;
-					LOGGER_LOG("VUELVE A 1\n");
+				if (EV_SETUP_NEXT == p_task_setup_dta->event && shared_params_dta.pack_rate == DEL_SYST_MAX_PACKS) {
+					shared_params_dta.pack_rate = DEL_SYST_MIN_PACK_RATE;
+					LOGGER_DEBUG("VUELVE A 1\n");
+				}
+
+				if (EV_SETUP_NEXT == p_task_setup_dta->event) {
+					publish_task_shared_params(p_task_shared_params, &shared_params_dta);
 				}
 
 				if (EV_SETUP_ESCAPE == p_task_setup_dta->event) {
-					LOGGER_LOG("VUELVO AL MENU INICIAL")
+					LOGGER_DEBUG("VUELVO AL MENU INICIAL")
 					p_task_setup_dta->state = ST_SETUP_INIT_MENU;
 					p_task_setup_dta->option = DEL_SETUP_DEF_OPTION;
 				}
 
+				if (EV_SETUP_OFF == p_task_setup_dta->event) {
+					p_task_setup_dta->option = DEL_SYST_MIN;
+					LOGGER_INFO("APAGO EL SET UP\n");
+					flash_eeprom_write(p_task_setup_dta->lane, &shared_params_dta);
+					put_event_task_normal(EV_NML_SETUP_OFF, p_task_setup_dta->lane);
+					p_task_setup_dta->state = ST_SETUP_NORMAL;
+				}
+
 				break;
 
 			case ST_SETUP_WAITING_TIME_MENU:
 
-				LOGGER_LOG("ESTOY EN EL MENU DEL WAITING TIME\n");
+				LOGGER_INFO_LIMIT(LOGGER_CONFIG_REPEAT_PERIOD_MS, "ESTOY EN EL MENU DEL WAITING TIME\n");
 
 				if (EV_SETUP_NEXT == p_task_setup_dta->event) {
-					p_task_shared_params_dta->waiting_time++;
-					LOGGER_LOG("VARIO EL WAITING TIME %lu\n", p_task_shared_params_dta->waiting_time);
+					shared_params_dta.waiting_time++;
+					LOGGER_INFO("VARIO EL WAITING TIME %lu\n", (unsigned long)shared_params_dta.waiting_time);
+				}
+
+				if (EV_SETUP_NEXT == p_task_setup_dta->event && shared_params_dta.waiting_time == DEL_SYST_MAX_WAITING_TIME) {
+					shared_params_dta.waiting_time = DEL_SYST_MIN_WAITING_TIME;
+					LOGGER_DEBUG("VUELVE A 1\n");
 				}
 
-				if (EV_SETUP_NEXT == p_task_setup_dta->event && p_task_shared_params_dta->waiting_time == DEL_SYST_MAX_WAITING_TIME) {
-					p_task_shared_params_dta->waiting_time = DEL_SYST_MIN_WAITING_TIME;
-					LOGGER_LOG("VUELVE A 1\n");
+				if (EV_SETUP_NEXT == p_task_setup_dta->event) {
+					publish_task_shared_params(p_task_shared_params, &shared_params_dta);
 				}
 
 				if (EV_SETUP_ESCAPE == p_task_setup_dta->event) {
-					LOGGER_LOG("VUELVO AL MENU INICIAL")
+					LOGGER_DEBUG("VUELVO AL MENU INICIAL")
 					p_task_setup_dta->state = ST_SETUP_INIT_MENU;
 					p_task_setup_dta->option = DEL_SETUP_DEF_OPTION;
 				}
 
+				if (EV_SETUP_OFF == p_task_setup_dta->event) {
+					p_task_setup_dta->option = DEL_SYST_MIN;
+					LOGGER_INFO("APAGO EL SET UP\n");
+					flash_eeprom_write(p_task_setup_dta->lane, &shared_params_dta);
+					put_event_task_normal(EV_NML_SETUP_OFF, p_task_setup_dta->lane);
+					p_task_setup_dta->state = ST_SETUP_NORMAL;
+				}
+
 				break;
 
 			case ST_SETUP_NORMAL:
 
 				if (EV_SETUP_ON == p_task_setup_dta->event) {
-					LOGGER_LOG("VOY AL INITIAL MENU\n");
+					LOGGER_INFO("VOY AL INITIAL MENU\n");
 					p_task_setup_dta->option = DEL_SETUP_DEF_OPTION;
-					put_event_task_normal(EV_NML_SETUP_ON);
+					put_event_task_normal(EV_NML_SETUP_ON, p_task_setup_dta->lane);
+					p_task_setup_dta->state = ST_SETUP_INIT_MENU;
 				}
 
 				break;
 		}
+
+		PROFILE_ZONE_END(PROFILE_ZONE_SETUP_FSM);
     }
 }
 
@@ -45,6 +45,7 @@
 /* Demo includes. */
 #include "logger.h"
 #include "dwt.h"
+#include "trace.h"
 
 /* Application & Tasks includes. */
 #include "board.h"
@@ -67,10 +68,13 @@ struct
 	uint32_t	tail;
 	uint32_t	count;
 	task_setup_ev_t	queue[MAX_EVENTS];
+	uint32_t	lane[MAX_EVENTS];		// Lane the event comes from
 } queue_task_a;
 
 /********************** external data declaration ****************************/
 
+/********************** internal functions definition ************************/
+
 /********************** external functions definition ************************/
 
 void init_queue_event_task_setup(void) {
@@ -80,28 +84,42 @@ void init_queue_event_task_setup(void) {
 	queue_task_a.tail = 0;
 	queue_task_a.count = 0;
 
-	for (i = 0; i < MAX_EVENTS; i++)
+	for (i = 0; i < MAX_EVENTS; i++) {
 		queue_task_a.queue[i] = EVENT_UNDEFINED;
+		queue_task_a.lane[i] = SYST_LANE_0;
+	}
 }
 
-void put_event_task_setup(task_setup_ev_t event) {
+/* Tags the event with the lane it comes from */
+void put_lane_event_task_setup(task_setup_ev_t event, uint32_t lane) {
+	TRACE_QUEUE_PUT(TRACE_QUEUE_SETUP, lane, event);
+
 	queue_task_a.count++;
+	queue_task_a.lane[queue_task_a.head] = lane;
 	queue_task_a.queue[queue_task_a.head++] = event;
 
 	if (MAX_EVENTS == queue_task_a.head)
 		queue_task_a.head = 0;
 }
 
-task_setup_ev_t get_event_task_setup(void) {
+void put_event_task_setup(task_setup_ev_t event) {
+	put_lane_event_task_setup(event, SYST_LANE_0);
+}
+
+/* Returns the event and, through p_lane, the lane it carries */
+task_setup_ev_t get_event_task_setup(uint32_t *p_lane) {
 	task_setup_ev_t event;
 
 	queue_task_a.count--;
 	event = queue_task_a.queue[queue_task_a.tail];
+	*p_lane = queue_task_a.lane[queue_task_a.tail];
 	queue_task_a.queue[queue_task_a.tail++] = EVENT_UNDEFINED;
 
 	if (MAX_EVENTS == queue_task_a.tail)
 		queue_task_a.tail = 0;
 
+	TRACE_QUEUE_GET(TRACE_QUEUE_SETUP, *p_lane, event);
+
 	return event;
 }
 
@@ -109,4 +127,15 @@ bool any_event_task_setup(void) {
   return (queue_task_a.head != queue_task_a.tail);
 }
 
+/* Events that can still be put, head == tail reads as empty so one slot is
+ * never used */
+uint32_t free_event_task_setup(void) {
+	return (MAX_EVENTS - 1ul) - queue_task_a.count;
+}
+
+/* Queued as EV_SETUP_LANE, Task Setup only switches lanes out of the menus */
+void put_lane_task_setup(uint32_t lane) {
+	put_lane_event_task_setup(EV_SETUP_LANE, lane);
+}
+
 /********************** end of file ******************************************/
@@ -0,0 +1,75 @@
+/*
+ * task_shared_params.c
+ *
+ */
+
+/********************** inclusions *******************************************/
+/* Project includes. */
+#include "task_shared_params.h"
+#include "main.h"
+
+/********************** macros and definitions *******************************/
+#define SHARED_PARAMS_UNLOCKED		0ul
+#define SHARED_PARAMS_LOCKED		1ul
+
+#define SHARED_PARAMS_ACTIVE(v)		((v) & 1ul)
+#define SHARED_PARAMS_INACTIVE(v)	(((v) + 1ul) & 1ul)
+
+/********************** internal data declaration ****************************/
+
+/********************** internal functions declaration ***********************/
+
+/********************** internal data definition *****************************/
+
+/********************** external data declaration ****************************/
+
+/********************** external functions definition ************************/
+void init_task_shared_params(task_shared_params_t *p_params, const task_shared_params_dta_t *p_dta) {
+	p_params->version = 0;
+	p_params->lock = SHARED_PARAMS_UNLOCKED;
+	p_params->buffer[0] = *p_dta;
+	p_params->buffer[1] = *p_dta;
+}
+
+/* Publish a complete parameter set. Writers are serialized by an exclusive
+ * (LDREX/STREX) lock instead of masking interrupts: a writer that preempts
+ * another one gets false and must retry later. From the main loop it always
+ * succeeds, as no writer can be preempted by it */
+bool publish_task_shared_params(task_shared_params_t *p_params, const task_shared_params_dta_t *p_dta) {
+	uint32_t version;
+
+	do {
+		if (SHARED_PARAMS_UNLOCKED != __LDREXW(&p_params->lock)) {
+			__CLREX();
+			return false;
+		}
+	} while (0ul != __STREXW(SHARED_PARAMS_LOCKED, &p_params->lock));
+	__DMB();
+
+	version = p_params->version;
+	p_params->buffer[SHARED_PARAMS_INACTIVE(version)] = *p_dta;
+
+	/* Buffer contents must be visible before the version that selects it */
+	__DMB();
+	p_params->version = version + 1ul;
+
+	__DMB();
+	p_params->lock = SHARED_PARAMS_UNLOCKED;
+
+	return true;
+}
+
+/* Take a consistent copy of the active parameter set. Retries only when a
+ * publish completed while copying, so it never spins from an ISR */
+void snapshot_task_shared_params(task_shared_params_t *p_params, task_shared_params_dta_t *p_dta) {
+	uint32_t version;
+
+	do {
+		version = p_params->version;
+		__DMB();
+		*p_dta = p_params->buffer[SHARED_PARAMS_ACTIVE(version)];
+		__DMB();
+	} while (version != p_params->version);
+}
+
+/********************** end of file ******************************************/
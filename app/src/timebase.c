@@ -0,0 +1,94 @@
+/*
+ * timebase.c
+ *
+ */
+
+/********************** inclusions *******************************************/
+/* Project includes. */
+#include "main.h"
+
+/* Application & Tasks includes. */
+#include "timebase.h"
+
+/********************** macros and definitions *******************************/
+#define TIMEBASE_NS_PER_S		1000000000ull
+#define TIMEBASE_US_PER_S		1000000ull
+
+#define TIMEBASE_HALF_POS		31ul
+
+/********************** internal data declaration ****************************/
+
+/********************** internal functions declaration ***********************/
+static uint64_t timebase_scale(uint64_t cycles, uint32_t mult, uint32_t shift);
+
+/********************** internal data definition *****************************/
+/* Half periods of CYCCNT (2^31 cycles) seen by timebase_update(). Its low
+ * bit follows CYCCNT bit 31, and one 32 bit store updates it, so readers in
+ * any context need no lock */
+static volatile uint32_t timebase_half_cnt;
+
+/********************** external data declaration ****************************/
+uint32_t timebase_mult_ns;
+uint32_t timebase_mult_us;
+
+/********************** internal functions definition ************************/
+/* cycles * mult >> shift, split so the product never overflows 64 bits */
+static uint64_t timebase_scale(uint64_t cycles, uint32_t mult, uint32_t shift) {
+	uint64_t high = (cycles >> 32) * mult;
+	uint64_t low = ((uint64_t)(uint32_t)cycles * mult) >> shift;
+
+	return (high << (32ul - shift)) + low;
+}
+
+/********************** external functions definition ************************/
+/* Start CYCCNT from 0 and compute the multipliers for SystemCoreClock,
+ * call again if the clock changes */
+void timebase_init(void) {
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0ul;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	timebase_half_cnt = 0ul;
+
+	timebase_mult_ns = (uint32_t)(((TIMEBASE_NS_PER_S << TIMEBASE_NS_SHIFT) + (SystemCoreClock / 2ul)) / SystemCoreClock);
+	timebase_mult_us = (uint32_t)(((TIMEBASE_US_PER_S << TIMEBASE_US_SHIFT) + (SystemCoreClock / 2ul)) / SystemCoreClock);
+}
+
+/* From the SysTick interrupt: a half period (33 s at 64 MHz) is far longer
+ * than a tick, so no bit 31 toggle is missed */
+void timebase_update(void) {
+	uint32_t half_cnt = timebase_half_cnt;
+
+	if ((DWT->CYCCNT >> TIMEBASE_HALF_POS) != (half_cnt & 1ul))
+		timebase_half_cnt = half_cnt + 1ul;
+}
+
+/* Monotonic 64 bit cycles. A toggle not yet seen by timebase_update() shows
+ * as a parity mismatch with the CYCCNT read after it */
+uint64_t timebase_get_cycles(void) {
+	uint32_t half_cnt = timebase_half_cnt;
+	uint32_t cycle_counter = DWT->CYCCNT;
+
+	if ((cycle_counter >> TIMEBASE_HALF_POS) != (half_cnt & 1ul))
+		half_cnt++;
+
+	return ((uint64_t)(half_cnt >> 1) << 32) | cycle_counter;
+}
+
+uint64_t timebase_get_ns(void) {
+	return timebase_scale(timebase_get_cycles(), timebase_mult_ns, TIMEBASE_NS_SHIFT);
+}
+
+uint64_t timebase_get_us(void) {
+	return timebase_scale(timebase_get_cycles(), timebase_mult_us, TIMEBASE_US_SHIFT);
+}
+
+uint64_t timebase_cycles_to_ns(uint64_t cycles) {
+	return timebase_scale(cycles, timebase_mult_ns, TIMEBASE_NS_SHIFT);
+}
+
+uint64_t timebase_cycles_to_us(uint64_t cycles) {
+	return timebase_scale(cycles, timebase_mult_us, TIMEBASE_US_SHIFT);
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,64 @@
+/*
+ * trace.c
+ *
+ */
+
+/********************** inclusions *******************************************/
+/* Project includes. */
+#include "main.h"
+
+/* Application & Tasks includes. */
+#include "trace.h"
+
+/********************** macros and definitions *******************************/
+#define TRACE_MASK		(TRACE_CONFIG_SIZE - 1ul)
+
+/********************** internal data declaration ****************************/
+
+/********************** internal functions declaration ***********************/
+
+/********************** internal data definition *****************************/
+
+/********************** external data declaration ****************************/
+trace_recorder_t trace_recorder;
+
+/********************** internal functions definition ************************/
+
+/********************** external functions definition ************************/
+void trace_init(void) {
+	trace_recorder.magic = TRACE_MAGIC;
+	trace_recorder.size = TRACE_CONFIG_SIZE;
+	trace_recorder.head = 0ul;
+	trace_recorder.cpu_hz = SystemCoreClock;
+	trace_recorder.enable = 1ul;
+}
+
+/* Stop to freeze the entries before a dump */
+void trace_enable(bool b_enable) {
+	trace_recorder.enable = b_enable ? 1ul : 0ul;
+}
+
+/* Safe from thread mode & any interrupt. CYCCNT is read inside the
+ * exclusive sequence, so an interrupt recording in between makes it retry
+ * and entries stay in time order */
+void trace_record(trace_ev_t type, uint32_t id, uint32_t arg) {
+	trace_entry_t *p_entry;
+	uint32_t head;
+	uint32_t cycle_counter;
+
+	if (0ul == trace_recorder.enable)
+		return;
+
+	do {
+		head = __LDREXW(&trace_recorder.head);
+		cycle_counter = DWT->CYCCNT;
+	} while (0ul != __STREXW(head + 1ul, &trace_recorder.head));
+
+	p_entry = &trace_recorder.entry[head & TRACE_MASK];
+	p_entry->cycle_counter = cycle_counter;
+	p_entry->type = (uint8_t)type;
+	p_entry->id = (uint8_t)id;
+	p_entry->arg = (uint16_t)arg;
+}
+
+/********************** end of file ******************************************/
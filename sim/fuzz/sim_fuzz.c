@@ -0,0 +1,399 @@
+/*
+ * sim_fuzz.c
+ *
+ */
+
+/* Fuzz target: every input boots the application on the simulated board
+ * and drives the sensor inputs and the command channel, one action per
+ * byte. The invariants of the tasks are checked after every tick, a
+ * violation aborts so the fuzzer keeps the input.
+ *
+ *   byte 0xF0..0xFF  command sim_fuzz_cmd_list[byte & 0x0F] on USART2,
+ *                    then 1 tick
+ *   other bytes      bits 0..2 input, bit 3 level (1 pressed), then
+ *                    ((byte >> 4) + 1) * SIM_FUZZ_TICK_STEP ticks
+ *
+ * libFuzzer (clang):
+ *   make -C sim fuzz CC=clang LIBFUZZER=1 BUILD=build/libfuzzer
+ *   sim/build/libfuzzer/fuzz/app_fuzz corpus/
+ *
+ * Standalone (any compiler), random inputs or the files given:
+ *   make -C sim fuzz
+ *   sim/build/fuzz/app_fuzz [-n inputs] [-s seed] [-l length] [file ...]
+ *
+ * fuzz/regress keeps the inputs of past findings, make -C sim check runs
+ * them */
+
+/********************** inclusions *******************************************/
+#include <unistd.h>
+
+/* Project includes. */
+#include "task_normal_attribute.h"
+#include "task_setup_attribute.h"
+#include "task_command_attribute.h"
+#include "task_shared_params.h"
+#include "main.h"
+
+/* Demo includes. */
+#include "logger.h"
+#include "trace.h"
+
+/* Application & Tasks includes. */
+#include "board.h"
+#include "app.h"
+#include "sim_hal.h"
+#include "sim_board.h"
+
+/********************** macros and definitions *******************************/
+#define SIM_FUZZ_INPUT_MAX			1024ul		// Bytes used of an input
+#define SIM_FUZZ_TICK_STEP			8ul
+#define SIM_FUZZ_CMD_MARK			0xF0u
+
+/* Private to the tasks, checked against from outside */
+#define SIM_FUZZ_QUEUE_ROOM			15ul		// MAX_EVENTS - 1, task_x_interface.c
+#define SIM_FUZZ_SETUP_OPTION_MAX	2ul			// Options of the initial menu
+
+#define SIM_FUZZ_NML_ST_QTY			(ST_NML_SETUP + 1ul)
+#define SIM_FUZZ_SETUP_ST_QTY		(ST_SETUP_WAITING_TIME_MENU + 1ul)
+
+#define SIM_FUZZ_RUNS_DEF			10000ul
+#define SIM_FUZZ_LENGTH_DEF			256ul
+#define SIM_FUZZ_CRASH_FILE			"sim_fuzz_crash.bin"
+
+typedef struct {
+	GPIO_TypeDef		*port;
+	uint16_t			pin;
+	GPIO_PinState		pressed;
+	GPIO_PinState		hover;
+} sim_fuzz_input_t;
+
+/********************** internal data declaration ****************************/
+extern task_shared_params_t shared_params[SYST_LANE_QTY];
+
+/********************** internal functions declaration ***********************/
+static void sim_fuzz_fail(const char *p_what, uint32_t value);
+static void sim_fuzz_boot(void);
+static void sim_fuzz_check_queue(void);
+static void sim_fuzz_check(void);
+
+/********************** internal data definition *****************************/
+/* Indexed by bits 0..2 of an input byte, same order as task_sensor_id_t */
+static const sim_fuzz_input_t sim_fuzz_input_list[] = {
+	{BTN_PACK_IN_PORT,			BTN_PACK_IN_PIN,			BTN_PACK_IN_PRESSED,			BTN_PACK_IN_HOVER},
+	{BTN_PACK_OUT_PORT,			BTN_PACK_OUT_PIN,			BTN_PACK_OUT_PRESSED,			BTN_PACK_OUT_HOVER},
+	{DIP_NORMAL_OR_SETUP_PORT,	DIP_NORMAL_OR_SETUP_PIN,	DIP_NORMAL_OR_SETUP_PRESSED,	DIP_NORMAL_OR_SETUP_HOVER},
+	{DIP_INFRARED_PORT,			DIP_INFRARED_PIN,			DIP_INFRARED_PRESSED,			DIP_INFRARED_HOVER},
+	{DIP_CTRL_SYST_PORT,		DIP_CTRL_SYST_PIN,			DIP_CTRL_SYST_PRESSED,			DIP_CTRL_SYST_HOVER},
+	{BTN_SETUP_ENTER_PORT,		BTN_SETUP_ENTER_PIN,		BTN_SETUP_ENTER_PRESSED,		BTN_SETUP_ENTER_HOVER},
+	{BTN_SETUP_NEXT_PORT,		BTN_SETUP_NEXT_PIN,			BTN_SETUP_NEXT_PRESSED,			BTN_SETUP_NEXT_HOVER},
+	{BTN_SETUP_ESCAPE_PORT,		BTN_SETUP_ESCAPE_PIN,		BTN_SETUP_ESCAPE_PRESSED,		BTN_SETUP_ESCAPE_HOVER}
+};
+
+/* Indexed by bits 0..3 of a command byte. "set trace 0" is left out, the
+ * queue check reads the trace recorder */
+static const char * const sim_fuzz_cmd_list[] = {
+	"key enter\n", "key next\n", "key escape\n", "key next 1\n",
+	"set pack_rate 1\n", "set pack_rate 9\n", "set pack_rate 0\n", "set pack_rate 10\n",
+	"set waiting_time 1\n", "set waiting_time 29\n", "get counters\n", "get pack_rate\n",
+	"set log_level 5\n", "set log_level 0\n", "get profile\n", "set\n"
+};
+
+/* State the application sets only by static initialization, taken before
+ * the first boot and put back before each one */
+static task_command_dta_t sim_fuzz_command_dta_ini;
+static uint32_t sim_fuzz_logger_level_ini;
+static bool sim_fuzz_ini_valid;
+
+/* Queue occupancy, from the puts and gets of the trace recorder */
+static uint32_t sim_fuzz_trace_tail;
+static uint32_t sim_fuzz_normal_qty[SYST_LANE_QTY];
+static uint32_t sim_fuzz_setup_qty;
+
+static uint32_t sim_fuzz_tick;
+
+/* Task Setup after the last check, its lane may only change out of the
+ * menus */
+static task_setup_st_t sim_fuzz_setup_st_last;
+static uint32_t sim_fuzz_setup_lane_last;
+
+/* States reached over all the inputs, bit per state */
+static uint32_t sim_fuzz_nml_st_seen;
+static uint32_t sim_fuzz_setup_st_seen;
+
+#ifndef SIM_FUZZ_LIBFUZZER
+static const uint8_t *sim_fuzz_data;
+static size_t sim_fuzz_size;
+#endif
+
+/********************** external data declaration ****************************/
+
+/********************** internal functions definition ************************/
+/* The standalone driver keeps the input, libFuzzer does it on abort */
+static void sim_fuzz_fail(const char *p_what, uint32_t value) {
+	fprintf(stderr, "sim_fuzz: %s (%lu) at tick %lu\n", p_what, (unsigned long)value, (unsigned long)sim_fuzz_tick);
+
+#ifndef SIM_FUZZ_LIBFUZZER
+	FILE *p_file = fopen(SIM_FUZZ_CRASH_FILE, "wb");
+
+	if (NULL != p_file) {
+		fwrite(sim_fuzz_data, 1, sim_fuzz_size, p_file);
+		fclose(p_file);
+		fprintf(stderr, "sim_fuzz: input saved to %s\n", SIM_FUZZ_CRASH_FILE);
+	}
+#endif
+
+	abort();
+}
+
+/* Power on: main() up to app_init(), inputs released */
+static void sim_fuzz_boot(void) {
+	uint32_t index;
+
+	if (false == sim_fuzz_ini_valid) {
+		sim_fuzz_command_dta_ini = task_command_dta;
+		sim_fuzz_logger_level_ini = logger_level;
+		sim_fuzz_ini_valid = true;
+	}
+
+	task_command_dta = sim_fuzz_command_dta_ini;
+	logger_level = sim_fuzz_logger_level_ini;
+	g_app_tick_cnt = 0ul;
+
+	sim_board_init();
+	sim_uart_out = NULL;
+
+	for (index = 0; (sizeof(sim_fuzz_input_list)/sizeof(sim_fuzz_input_t)) > index; index++)
+		sim_gpio_input(sim_fuzz_input_list[index].port, sim_fuzz_input_list[index].pin, sim_fuzz_input_list[index].hover);
+
+	app_init();
+
+	sim_fuzz_trace_tail = trace_recorder.head;
+	sim_fuzz_setup_qty = 0ul;
+
+	for (index = 0; SYST_LANE_QTY > index; index++)
+		sim_fuzz_normal_qty[index] = 0ul;
+
+	sim_fuzz_tick = 0ul;
+	sim_fuzz_setup_st_last = task_setup_dta.state;
+	sim_fuzz_setup_lane_last = task_setup_dta.lane;
+}
+
+/* head == tail means empty, so a put on a queue holding MAX_EVENTS - 1
+ * events empties it. A get on an empty one returns EVENT_UNDEFINED */
+static void sim_fuzz_check_queue(void) {
+	const trace_entry_t *p_entry;
+	uint32_t head = trace_recorder.head;
+	uint32_t *p_qty;
+	uint32_t lane;
+
+	if (TRACE_CONFIG_SIZE < (head - sim_fuzz_trace_tail))
+		sim_fuzz_fail("trace ring overrun, queues not tracked", head - sim_fuzz_trace_tail);
+
+	for (; head != sim_fuzz_trace_tail; sim_fuzz_trace_tail++) {
+		p_entry = &trace_recorder.entry[sim_fuzz_trace_tail % TRACE_CONFIG_SIZE];
+
+		if ((TRACE_EV_QUEUE_PUT != p_entry->type) && (TRACE_EV_QUEUE_GET != p_entry->type))
+			continue;
+
+		if (TRACE_QUEUE_NORMAL == p_entry->id) {
+			lane = (uint32_t)(p_entry->arg >> 8);
+
+			if (SYST_LANE_QTY <= lane)
+				sim_fuzz_fail("normal queue lane", lane);
+
+			p_qty = &sim_fuzz_normal_qty[lane];
+		}
+		else if (TRACE_QUEUE_SETUP == p_entry->id)
+			p_qty = &sim_fuzz_setup_qty;
+		else
+			continue;
+
+		if (TRACE_EV_QUEUE_PUT == p_entry->type) {
+			if (SIM_FUZZ_QUEUE_ROOM <= *p_qty)
+				sim_fuzz_fail((TRACE_QUEUE_NORMAL == p_entry->id) ? "normal queue overflow" : "setup queue overflow",
+							  p_entry->arg & 0xFFu);
+
+			(*p_qty)++;
+		}
+		else {
+			if (0ul == *p_qty)
+				sim_fuzz_fail((TRACE_QUEUE_NORMAL == p_entry->id) ? "normal queue read empty" : "setup queue read empty",
+							  p_entry->arg & 0xFFu);
+
+			(*p_qty)--;
+		}
+	}
+}
+
+static void sim_fuzz_check(void) {
+	task_shared_params_dta_t shared_params_dta;
+	uint32_t lane;
+
+	sim_fuzz_check_queue();
+
+	for (lane = 0; SYST_LANE_QTY > lane; lane++) {
+		if (SIM_FUZZ_NML_ST_QTY <= (uint32_t)task_normal_dta.state[lane])
+			sim_fuzz_fail("normal state", (uint32_t)task_normal_dta.state[lane]);
+
+		sim_fuzz_nml_st_seen |= 1ul << task_normal_dta.state[lane];
+
+		if (DEL_SYST_MAX_PACKS < task_normal_dta.qty_packs[lane])
+			sim_fuzz_fail("qty_packs above DEL_SYST_MAX_PACKS", task_normal_dta.qty_packs[lane]);
+
+		if ((DEL_NML_MAX_SPEED < task_normal_dta.speed[lane]) || (DEL_NML_MAX_SPEED < task_normal_dta.target_speed[lane]))
+			sim_fuzz_fail("speed above the maximum", task_normal_dta.speed[lane]);
+
+		if ((ST_NML_IDLE != task_normal_dta.state[lane]) && (DEL_NML_MIN_SPEED > task_normal_dta.speed[lane]))
+			sim_fuzz_fail("line stopped out of idle", task_normal_dta.speed[lane]);
+
+		snapshot_task_shared_params(&shared_params[lane], &shared_params_dta);
+
+		if (DEL_SYST_MAX_PACKS < shared_params_dta.pack_rate)
+			sim_fuzz_fail("pack_rate above DEL_SYST_MAX_PACKS", shared_params_dta.pack_rate);
+
+		if (DEL_SYST_MAX_WAITING_TIME < shared_params_dta.waiting_time)
+			sim_fuzz_fail("waiting_time above DEL_SYST_MAX_WAITING_TIME", shared_params_dta.waiting_time);
+	}
+
+	if (SIM_FUZZ_SETUP_ST_QTY <= (uint32_t)task_setup_dta.state)
+		sim_fuzz_fail("setup state", (uint32_t)task_setup_dta.state);
+
+	sim_fuzz_setup_st_seen |= 1ul << task_setup_dta.state;
+
+	if (SIM_FUZZ_SETUP_OPTION_MAX < task_setup_dta.option)
+		sim_fuzz_fail("setup option", task_setup_dta.option);
+
+	if (SYST_LANE_QTY <= task_setup_dta.lane)
+		sim_fuzz_fail("setup lane", task_setup_dta.lane);
+
+	if ((ST_SETUP_NORMAL != sim_fuzz_setup_st_last) && (ST_SETUP_NORMAL != task_setup_dta.state)
+			&& (sim_fuzz_setup_lane_last != task_setup_dta.lane))
+		sim_fuzz_fail("setup lane switched under a menu", task_setup_dta.lane);
+
+	sim_fuzz_setup_st_last = task_setup_dta.state;
+	sim_fuzz_setup_lane_last = task_setup_dta.lane;
+}
+
+/********************** external functions definition ************************/
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+	const sim_fuzz_input_t *p_input;
+	const char *p_cmd;
+	uint32_t ticks;
+	size_t index;
+
+#ifndef SIM_FUZZ_LIBFUZZER
+	sim_fuzz_data = data;
+	sim_fuzz_size = size;
+#endif
+
+	sim_fuzz_boot();
+	sim_fuzz_check();
+
+	if (SIM_FUZZ_INPUT_MAX < size)
+		size = SIM_FUZZ_INPUT_MAX;
+
+	for (index = 0; size > index; index++) {
+		if (SIM_FUZZ_CMD_MARK == (data[index] & SIM_FUZZ_CMD_MARK)) {
+			p_cmd = sim_fuzz_cmd_list[data[index] & 0x0Fu];
+			sim_uart_rx((const uint8_t *)p_cmd, (uint32_t)strlen(p_cmd));
+			ticks = 1ul;
+		}
+		else {
+			p_input = &sim_fuzz_input_list[data[index] & 0x07u];
+			sim_gpio_input(p_input->port, p_input->pin, (0u != (data[index] & 0x08u)) ? p_input->pressed : p_input->hover);
+			ticks = ((uint32_t)(data[index] >> 4) + 1ul) * SIM_FUZZ_TICK_STEP;
+		}
+
+		for (; 0ul < ticks; ticks--) {
+			sim_board_tick();
+			sim_fuzz_tick++;
+			sim_fuzz_check();
+		}
+	}
+
+	return 0;
+}
+
+#ifndef SIM_FUZZ_LIBFUZZER
+/* Files given: each one run once. Otherwise random inputs of random length,
+ * reproducible from the seed, and the states never reached are listed */
+int main(int argc, char *argv[]) {
+	static uint8_t data[SIM_FUZZ_INPUT_MAX];
+	uint32_t runs = SIM_FUZZ_RUNS_DEF;
+	uint32_t length = SIM_FUZZ_LENGTH_DEF;
+	uint32_t seed = 1ul;
+	uint32_t run;
+	uint32_t index;
+	size_t size;
+	FILE *p_file;
+	bool files;
+	int option;
+
+	while (-1 != (option = getopt(argc, argv, "n:s:l:"))) {
+		switch (option) {
+			case 'n': runs = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 's': seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'l': length = (uint32_t)strtoul(optarg, NULL, 0); break;
+			default:
+				fprintf(stderr, "usage: %s [-n inputs] [-s seed] [-l length] [file ...]\n", argv[0]);
+				return EXIT_FAILURE;
+		}
+	}
+
+	if ((0ul == seed) || (0ul == length) || (SIM_FUZZ_INPUT_MAX < length)) {
+		fprintf(stderr, "sim_fuzz: seed must not be 0, length 1..%lu\n", (unsigned long)SIM_FUZZ_INPUT_MAX);
+		return EXIT_FAILURE;
+	}
+
+	files = (optind < argc);
+
+	if (files) {
+		runs = (uint32_t)(argc - optind);
+
+		for (; optind < argc; optind++) {
+			if (NULL == (p_file = fopen(argv[optind], "rb"))) {
+				fprintf(stderr, "sim_fuzz: cannot open %s\n", argv[optind]);
+				return EXIT_FAILURE;
+			}
+
+			size = fread(data, 1, sizeof(data), p_file);
+			fclose(p_file);
+			LLVMFuzzerTestOneInput(data, size);
+		}
+	}
+	else {
+		for (run = 0; runs > run; run++) {
+			/* xorshift32 */
+			for (index = 0; length > index; index++) {
+				seed ^= seed << 13;
+				seed ^= seed >> 17;
+				seed ^= seed << 5;
+				data[index] = (uint8_t)seed;
+			}
+
+			LLVMFuzzerTestOneInput(data, 1ul + (seed % length));
+		}
+	}
+
+	fprintf(stderr, "sim_fuzz: %lu inputs, no invariant broken\n", (unsigned long)runs);
+
+	/* Coverage of the random inputs only, the files given are not meant to
+	 * reach every state */
+	if (files)
+		return EXIT_SUCCESS;
+
+	for (index = 0; SIM_FUZZ_NML_ST_QTY > index; index++) {
+		if (0ul == (sim_fuzz_nml_st_seen & (1ul << index)))
+			fprintf(stderr, "sim_fuzz: normal state %lu never reached\n", (unsigned long)index);
+	}
+
+	for (index = 0; SIM_FUZZ_SETUP_ST_QTY > index; index++) {
+		if (0ul == (sim_fuzz_setup_st_seen & (1ul << index)))
+			fprintf(stderr, "sim_fuzz: setup state %lu never reached\n", (unsigned long)index);
+	}
+
+	return EXIT_SUCCESS;
+}
+#endif
+
+/********************** end of file ******************************************/
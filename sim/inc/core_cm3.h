@@ -0,0 +1,165 @@
+/*
+ * core_cm3.h
+ *
+ */
+
+/* Host build only, found before Drivers/CMSIS/Include (see sim/Makefile).
+ * The register definitions of the real core_cm3.h are kept, only the
+ * intrinsics of cmsis_gcc.h are replaced: ARM instructions cannot be
+ * assembled for the host, sim_cpu.c stands in for them */
+
+#ifndef SIM_INC_CORE_CM3_H_
+#define SIM_INC_CORE_CM3_H_
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+
+/* Before __asm is redefined below, the C library headers use it */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/********************** macros ***********************************************/
+
+/* Keeps cmsis_compiler.h from including cmsis_gcc.h */
+#define __CMSIS_GCC_H
+
+#define __ASM									__asm__
+#define __INLINE								inline
+#define __STATIC_INLINE							static inline
+#define __STATIC_FORCEINLINE					__attribute__((always_inline)) static inline
+#define __NO_RETURN								__attribute__((__noreturn__))
+#define __USED									__attribute__((used))
+#define __WEAK									__attribute__((weak))
+#define __PACKED								__attribute__((packed, aligned(1)))
+#define __PACKED_STRUCT							struct __attribute__((packed, aligned(1)))
+#define __PACKED_UNION							union __attribute__((packed, aligned(1)))
+#define __ALIGNED(x)							__attribute__((aligned(x)))
+#define __RESTRICT								__restrict
+#define __COMPILER_BARRIER()					__atomic_signal_fence(__ATOMIC_SEQ_CST)
+
+#define __UNALIGNED_UINT16_READ(addr)			(*(const uint16_t *)(const void *)(addr))
+#define __UNALIGNED_UINT16_WRITE(addr, val)		(void)(*(uint16_t *)(void *)(addr) = (val))
+#define __UNALIGNED_UINT32_READ(addr)			(*(const uint32_t *)(const void *)(addr))
+#define __UNALIGNED_UINT32_WRITE(addr, val)		(void)(*(uint32_t *)(void *)(addr) = (val))
+
+/* Single core, in order: barriers only have to stop the compiler */
+#define __NOP()									__COMPILER_BARRIER()
+#define __WFI()									__COMPILER_BARRIER()
+#define __WFE()									__COMPILER_BARRIER()
+#define __SEV()									__COMPILER_BARRIER()
+#define __ISB()									__COMPILER_BARRIER()
+#define __DSB()									__COMPILER_BARRIER()
+#define __DMB()									__COMPILER_BARRIER()
+
+#define __BKPT(value)							sim_cpu_bkpt(value)
+
+#define __enable_irq()							sim_cpu_irq_enable()
+#define __disable_irq()							sim_cpu_irq_disable()
+#define __get_IPSR()							(sim_cpu.ipsr)
+#define __get_PRIMASK()							(sim_cpu.primask)
+
+/********************** typedef **********************************************/
+
+/* Simulated core registers, see sim_cpu.c */
+typedef struct
+{
+	volatile uint32_t	primask;	// CPSID i / CPSIE i
+	volatile uint32_t	ipsr;		// Exception number, 0 in thread mode
+	volatile uint32_t	pend;		// Pending interrupts, bit per sim_cpu_irq_t
+} sim_cpu_t;
+
+/********************** external data declaration ****************************/
+extern sim_cpu_t sim_cpu;
+
+/********************** external functions declaration ***********************/
+extern void sim_cpu_irq_disable(void);
+extern void sim_cpu_irq_enable(void);
+extern void sim_cpu_bkpt(uint32_t value);
+
+/********************** internal functions definition ************************/
+
+__STATIC_FORCEINLINE void __set_PRIMASK(uint32_t primask) {
+	if (0ul != primask)
+		sim_cpu_irq_disable();
+	else
+		sim_cpu_irq_enable();
+}
+
+/* CLZ of 0 is 32 on the core, undefined for __builtin_clz */
+__STATIC_FORCEINLINE uint8_t __CLZ(uint32_t value) {
+	return (0ul == value) ? 32u : (uint8_t)__builtin_clz(value);
+}
+
+__STATIC_FORCEINLINE uint32_t __RBIT(uint32_t value) {
+	uint32_t result = 0ul;
+	uint32_t bit;
+
+	for (bit = 0ul; 32ul > bit; bit++)
+		result |= ((value >> bit) & 1ul) << (31ul - bit);
+
+	return result;
+}
+
+#define __REV(value)							__builtin_bswap32(value)
+#define __REV16(value)							((uint32_t)(((value) & 0xFF00FF00ul) >> 8) | (((value) & 0x00FF00FFul) << 8))
+#define __REVSH(value)							((int16_t)__builtin_bswap16((uint16_t)(value)))
+#define __ROR(op1, op2)							(((op1) >> ((op2) & 31ul)) | ((op1) << ((32ul - (op2)) & 31ul)))
+
+/* Interrupts only run where the simulated core takes them (sim_cpu.c),
+ * never between LDREX and STREX, so every store-exclusive succeeds */
+__STATIC_FORCEINLINE uint8_t __LDREXB(volatile uint8_t *addr) {
+	return *addr;
+}
+
+__STATIC_FORCEINLINE uint16_t __LDREXH(volatile uint16_t *addr) {
+	return *addr;
+}
+
+__STATIC_FORCEINLINE uint32_t __LDREXW(volatile uint32_t *addr) {
+	return *addr;
+}
+
+__STATIC_FORCEINLINE uint32_t __STREXB(uint8_t value, volatile uint8_t *addr) {
+	*addr = value;
+	return 0ul;
+}
+
+__STATIC_FORCEINLINE uint32_t __STREXH(uint16_t value, volatile uint16_t *addr) {
+	*addr = value;
+	return 0ul;
+}
+
+__STATIC_FORCEINLINE uint32_t __STREXW(uint32_t value, volatile uint32_t *addr) {
+	*addr = value;
+	return 0ul;
+}
+
+__STATIC_FORCEINLINE void __CLREX(void) {
+}
+
+/********************** inclusions *******************************************/
+
+/* __NVIC_SetVector / __NVIC_GetVector turn VTOR into a pointer, unused */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wint-to-pointer-cast"
+#include_next <core_cm3.h>
+#pragma GCC diagnostic pop
+
+/* The application masks interrupts with __asm("CPSID i") / __asm("CPSIE i") */
+#define __asm(code)								(('D' == (code)[4]) ? sim_cpu_irq_disable() : sim_cpu_irq_enable())
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_INC_CORE_CM3_H_ */
+
+/********************** end of file ******************************************/
@@ -0,0 +1,42 @@
+/*
+ * sim_board.h
+ *
+ */
+
+#ifndef SIM_INC_SIM_BOARD_H_
+#define SIM_INC_SIM_BOARD_H_
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "main.h"
+
+/********************** macros ***********************************************/
+
+/* SystemClock_Config(): HSI / 2 * 16 */
+#define SIM_BOARD_HCLK_HZ		64000000ul
+#define SIM_BOARD_TICK_HZ		1000ul
+
+/********************** typedef **********************************************/
+
+/********************** external data declaration ****************************/
+
+/********************** external functions declaration ***********************/
+extern void sim_board_init(void);
+extern void sim_board_tick(void);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_INC_SIM_BOARD_H_ */
+
+/********************** end of file ******************************************/
@@ -0,0 +1,53 @@
+/*
+ * sim_cpu.h
+ *
+ */
+
+#ifndef SIM_INC_SIM_CPU_H_
+#define SIM_INC_SIM_CPU_H_
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "main.h"
+
+/********************** macros ***********************************************/
+
+/* Memory of the STM32F103RB kept at its own addresses, so the register
+ * macros of the device header and the pointer to uint32_t casts of the
+ * application work unchanged (the binary is linked -no-pie) */
+#define SIM_CPU_FLASH_SIZE		(128ul * 1024ul)
+#define SIM_CPU_SRAM_SIZE		(20ul * 1024ul)
+#define SIM_CPU_PERIPH_SIZE		0x30000ul		// APB1, APB2 and AHB
+#define SIM_CPU_PPB_BASE		ITM_BASE		// ITM, DWT, SCS, DBGMCU
+#define SIM_CPU_PPB_SIZE		0x100000ul
+
+/********************** typedef **********************************************/
+
+/* Interrupts taken by the simulated core, lowest first when several pend */
+typedef enum sim_cpu_irq {SIM_CPU_IRQ_SYSTICK,
+						  SIM_CPU_IRQ_UART_TX,		// USART2 TX DMA transfer complete
+						  SIM_CPU_IRQ_UART_RX,		// USART2 RX DMA half/full or IDLE
+						  SIM_CPU_IRQ_QTY} sim_cpu_irq_t;
+
+/********************** external data declaration ****************************/
+
+/********************** external functions declaration ***********************/
+extern void sim_cpu_init(void);
+extern void sim_cpu_irq_raise(sim_cpu_irq_t irq);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_INC_SIM_CPU_H_ */
+
+/********************** end of file ******************************************/
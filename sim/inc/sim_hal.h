@@ -0,0 +1,61 @@
+/*
+ * sim_hal.h
+ *
+ */
+
+#ifndef SIM_INC_SIM_HAL_H_
+#define SIM_INC_SIM_HAL_H_
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "main.h"
+
+/********************** macros ***********************************************/
+
+/* GPIOA..GPIOE, 0x400 bytes apart */
+#define SIM_GPIO_PORT_QTY		5ul
+
+/* sim_flash_cut(): no cut */
+#define SIM_FLASH_OP_ALL		0xFFFFFFFFul
+
+/********************** typedef **********************************************/
+
+/********************** external data declaration ****************************/
+/* USART2 TX bytes go there as each DMA transfer completes, NULL drops them */
+extern FILE *sim_uart_out;
+
+/* Also handed the same bytes when set, whatever sim_uart_out is */
+extern void (*sim_uart_tap)(const uint8_t *data, uint32_t len);
+
+/********************** external functions declaration ***********************/
+extern void sim_hal_init(void);
+
+extern void sim_gpio_input(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state);
+extern GPIO_PinState sim_gpio_output(GPIO_TypeDef *port, uint16_t pin);
+extern void sim_gpio_sync(void);
+
+extern void sim_uart_rx(const uint8_t *data, uint32_t len);
+extern void sim_uart_irq_tx(void);
+extern void sim_uart_irq_rx(void);
+
+extern bool sim_flash_load(const char *path);
+extern bool sim_flash_save(const char *path);
+extern void sim_flash_cut(uint32_t op_qty);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_INC_SIM_HAL_H_ */
+
+/********************** end of file ******************************************/
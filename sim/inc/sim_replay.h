@@ -0,0 +1,64 @@
+/*
+ * sim_replay.h
+ *
+ */
+
+#ifndef SIM_INC_SIM_REPLAY_H_
+#define SIM_INC_SIM_REPLAY_H_
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+
+/* Input trace, one item per line, ms never going back:
+ *
+ *   # comment
+ *   <ms> <input> <1|0>      pressed (switch on) | released (switch off)
+ *   <ms> cmd <text>         command line sent on USART2
+ *   <ms> end                last tick run, default: last item
+ *
+ * inputs: pack_in pack_out setup infrared ctrl enter next escape
+ *
+ * Capture (golden file), one line per change, in tick order:
+ *
+ *   <ms> in <input> <1|0>               input applied
+ *   <ms> put|get <queue> <lane> <event> normal setup actuator bar queues
+ *   <ms> out <output> <1|0>             LED pin level, after the tick
+ *   <ms> params <lane> <pack_rate> <waiting_time>   published, after the tick
+ *   <ms> uart <text>                    USART2 text line, deferred log
+ *                                       records left out
+ *
+ * An item at <ms> is applied before the SysTick of that tick, so
+ * task_sensor_update() of the same tick already reads it */
+#define SIM_REPLAY_CMD_MAXLEN	64ul
+
+/********************** typedef **********************************************/
+
+/********************** external data declaration ****************************/
+
+/********************** external functions declaration ***********************/
+extern bool sim_replay_load(const char *path);
+extern uint32_t sim_replay_end(void);
+extern void sim_replay_apply(uint32_t time_ms);
+
+extern bool sim_replay_capture_start(void);
+extern void sim_replay_capture(uint32_t time_ms);
+extern bool sim_replay_capture_save(const char *path);
+extern bool sim_replay_capture_compare(const char *path);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_INC_SIM_REPLAY_H_ */
+
+/********************** end of file ******************************************/
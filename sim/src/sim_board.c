@@ -0,0 +1,128 @@
+/*
+ * sim_board.c
+ *
+ */
+
+/* What Core/ provides on the target: clock and peripheral handles of
+ * main.c, the interrupt handlers of stm32f1xx_it.c and the heap counters of
+ * sysmem.c */
+
+/********************** inclusions *******************************************/
+/* Project includes. */
+#include "main.h"
+#include "stm32f1xx_it.h"
+#include "sysmem.h"
+
+/* Demo includes. */
+#include "irq_stat.h"
+#include "trace.h"
+
+/* Application & Tasks includes. */
+#include "app.h"
+#include "sim_cpu.h"
+#include "sim_hal.h"
+#include "sim_board.h"
+
+/********************** macros and definitions *******************************/
+#define SIM_BOARD_CYCLES_PER_TICK	(SystemCoreClock / SIM_BOARD_TICK_HZ)
+
+/********************** internal data declaration ****************************/
+
+/********************** internal functions declaration ***********************/
+void *__real_malloc(size_t size);
+
+/********************** internal data definition *****************************/
+static bool sim_board_sealed;
+
+/********************** external data declaration ****************************/
+uint32_t SystemCoreClock = SIM_BOARD_HCLK_HZ;
+
+UART_HandleTypeDef huart2;
+
+sysmem_stat_t sysmem_stat;
+sysmem_site_t sysmem_site_list[SYSMEM_SITE_QTY];
+
+/********************** internal functions definition ************************/
+
+/********************** external functions definition ************************/
+/* main() up to app_init(): HAL_Init() starts SysTick, MX_xxx_Init() leaves
+ * the outputs low and USART2 ready */
+void sim_board_init(void) {
+	sim_cpu_init();
+	sim_hal_init();
+
+	SysTick->LOAD = SIM_BOARD_CYCLES_PER_TICK - 1ul;
+	SysTick->VAL = 0ul;
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+
+	huart2.Instance = USART2;
+	sim_board_sealed = false;
+}
+
+/* One SysTick period of the superloop. The application takes no virtual
+ * time: CYCCNT moves a whole period at the reload, SysTick is taken with no
+ * latency and every task of the tick runs before the next one */
+void sim_board_tick(void) {
+	if ((0ul != (CoreDebug->DEMCR & CoreDebug_DEMCR_TRCENA_Msk)) && (0ul != (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)))
+		DWT->CYCCNT += SIM_BOARD_CYCLES_PER_TICK;
+
+	SysTick->VAL = SysTick->LOAD;
+	sim_cpu_irq_raise(SIM_CPU_IRQ_SYSTICK);
+
+	app_update();
+	sim_gpio_sync();
+}
+
+void SysTick_Handler(void) {
+	IRQ_STAT_SYSTICK_LATENCY();
+	TRACE_ISR_ENTER();
+
+	HAL_IncTick();
+	HAL_SYSTICK_IRQHandler();
+
+	TRACE_ISR_EXIT();
+}
+
+void DMA1_Channel7_IRQHandler(void) {
+	TRACE_ISR_ENTER();
+	sim_uart_irq_tx();
+	TRACE_ISR_EXIT();
+}
+
+void USART2_IRQHandler(void) {
+	TRACE_ISR_ENTER();
+	sim_uart_irq_rx();
+	TRACE_ISR_EXIT();
+}
+
+void sysmem_seal(void) {
+	sim_board_sealed = true;
+}
+
+/* The application links against the host libc, only its own calls are
+ * counted (-Wl,--wrap=malloc), by call site as in the Debug build */
+void *__wrap_malloc(size_t size) {
+	const uint32_t site = (uint32_t)(uintptr_t)__builtin_return_address(0);
+	uint32_t index;
+
+	sysmem_stat.alloc_cnt++;
+
+	if (sim_board_sealed)
+		sysmem_stat.late_cnt++;
+
+	for (index = 0; SYSMEM_SITE_QTY > index; index++) {
+		if ((0ul == sysmem_site_list[index].cnt) || (site == sysmem_site_list[index].site)) {
+			sysmem_site_list[index].site = site;
+			sysmem_site_list[index].cnt++;
+			sysmem_site_list[index].bytes += (uint32_t)size;
+			break;
+		}
+	}
+
+	if (SYSMEM_SITE_QTY == index)
+		sysmem_stat.site_lost_cnt++;
+
+	return __real_malloc(size);
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,138 @@
+/*
+ * sim_cpu.c
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <sys/mman.h>
+
+/* Project includes. */
+#include "main.h"
+#include "stm32f1xx_it.h"
+
+/* Demo includes. */
+#include "stack_monitor.h"
+
+/* Application & Tasks includes. */
+#include "sim_cpu.h"
+
+/********************** macros and definitions *******************************/
+#define SIM_CPU_EXC_OFFSET		16ul	// IPSR of IRQ 0
+
+typedef struct {
+	uintptr_t	base;
+	size_t		size;
+} sim_cpu_region_t;
+
+typedef struct {
+	void		(*handler)(void);
+	uint32_t	ipsr;
+} sim_cpu_vector_t;
+
+/********************** internal data declaration ****************************/
+extern uint32_t _estack[];
+
+/********************** internal functions declaration ***********************/
+static void sim_cpu_irq_take(void);
+
+/********************** internal data definition *****************************/
+static const sim_cpu_region_t sim_cpu_region_list[] = {
+	{FLASH_BASE,		SIM_CPU_FLASH_SIZE},
+	{SRAM_BASE,			SIM_CPU_SRAM_SIZE},
+	{PERIPH_BASE,		SIM_CPU_PERIPH_SIZE},
+	{SIM_CPU_PPB_BASE,	SIM_CPU_PPB_SIZE}
+};
+
+#define SIM_CPU_REGION_QTY	(sizeof(sim_cpu_region_list)/sizeof(sim_cpu_region_t))
+
+static bool sim_cpu_mapped;
+
+/* Indexed by sim_cpu_irq_t, same handlers as the vector table of the target */
+static const sim_cpu_vector_t sim_cpu_vector_list[SIM_CPU_IRQ_QTY] = {
+	{SysTick_Handler,			(uint32_t)(SIM_CPU_EXC_OFFSET + SysTick_IRQn)},
+	{DMA1_Channel7_IRQHandler,	(uint32_t)(SIM_CPU_EXC_OFFSET + DMA1_Channel7_IRQn)},
+	{USART2_IRQHandler,			(uint32_t)(SIM_CPU_EXC_OFFSET + USART2_IRQn)}
+};
+
+/********************** external data declaration ****************************/
+sim_cpu_t sim_cpu;
+
+/********************** internal functions definition ************************/
+/* Handlers run to completion one after the other, none preempts another */
+static void sim_cpu_irq_take(void) {
+	uint32_t irq;
+
+	if ((0ul != sim_cpu.primask) || (0ul != sim_cpu.ipsr))
+		return;
+
+	while (0ul != sim_cpu.pend) {
+		irq = (uint32_t)__builtin_ctz(sim_cpu.pend);
+		sim_cpu.pend &= ~(1ul << irq);
+
+		sim_cpu.ipsr = sim_cpu_vector_list[irq].ipsr;
+		sim_cpu_vector_list[irq].handler();
+		sim_cpu.ipsr = 0ul;
+	}
+}
+
+/********************** external functions definition ************************/
+/* Map the memory of the target (flash erased, SRAM painted as the startup
+ * code leaves it) and reset the core. Called again, the memory is cleared
+ * as a power cycle would, so a host process can run several boots */
+void sim_cpu_init(void) {
+	const sim_cpu_region_t *p_region;
+	uint32_t *p_word;
+	uint32_t index;
+	void *p_map;
+
+	for (index = 0; SIM_CPU_REGION_QTY > index; index++) {
+		p_region = &sim_cpu_region_list[index];
+
+		if (sim_cpu_mapped) {
+			memset((void *)p_region->base, 0, p_region->size);
+			continue;
+		}
+
+		p_map = mmap((void *)p_region->base, p_region->size, PROT_READ | PROT_WRITE,
+					 MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+		if ((void *)p_region->base != p_map) {
+			fprintf(stderr, "sim: cannot map 0x%08lx, %lu bytes\n", (unsigned long)p_region->base, (unsigned long)p_region->size);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	sim_cpu_mapped = true;
+	memset((void *)FLASH_BASE, 0xFF, SIM_CPU_FLASH_SIZE);
+
+	for (p_word = (uint32_t *)SRAM_BASE; p_word < _estack; p_word++)
+		*p_word = STACK_MONITOR_PAINT;
+
+	sim_cpu.primask = 0ul;
+	sim_cpu.ipsr = 0ul;
+	sim_cpu.pend = 0ul;
+}
+
+/* Pend the interrupt, taken right away unless masked or already in one */
+void sim_cpu_irq_raise(sim_cpu_irq_t irq) {
+	sim_cpu.pend |= 1ul << irq;
+	sim_cpu_irq_take();
+}
+
+void sim_cpu_irq_disable(void) {
+	sim_cpu.primask = 1ul;
+}
+
+/* CPSIE i takes whatever pended while masked */
+void sim_cpu_irq_enable(void) {
+	sim_cpu.primask = 0ul;
+	sim_cpu_irq_take();
+}
+
+/* A breakpoint with no debugger attached escalates to HardFault */
+void sim_cpu_bkpt(uint32_t value) {
+	fprintf(stderr, "sim: BKPT %lu\n", (unsigned long)value);
+	abort();
+}
+
+/********************** end of file ******************************************/
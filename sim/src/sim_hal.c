@@ -0,0 +1,333 @@
+/*
+ * sim_hal.c
+ *
+ */
+
+/* The few HAL functions the application calls, over the register memory
+ * mapped by sim_cpu.c. Plain stores to a register (BSRR) only take effect
+ * at sim_gpio_sync(), the driver calls it after every app_update() */
+
+/********************** inclusions *******************************************/
+/* Project includes. */
+#include "main.h"
+
+/* Demo includes. */
+#include "flash_eeprom.h"
+
+/* Application & Tasks includes. */
+#include "sim_cpu.h"
+#include "sim_hal.h"
+
+/********************** macros and definitions *******************************/
+#define SIM_GPIO_PORT(index)		((GPIO_TypeDef *)(GPIOA_BASE + ((index) * (GPIOB_BASE - GPIOA_BASE))))
+#define SIM_GPIO_BSRR_RESET_POS		16ul
+
+#define SIM_FLASH_ERASED			0xFFFFu
+#define SIM_FLASH_EEPROM_SIZE		(FLASH_EEPROM_PAGE_QTY * FLASH_PAGE_SIZE)
+
+typedef struct {
+	UART_HandleTypeDef	*huart;
+	const uint8_t		*data;
+	uint32_t			len;		// 0: no transfer in flight
+} sim_uart_tx_t;
+
+typedef struct {
+	UART_HandleTypeDef	*huart;		// NULL: reception stopped
+	uint8_t				*buffer;
+	uint32_t			size;
+	uint32_t			pos;		// Next byte written by the DMA
+} sim_uart_rx_t;
+
+/********************** internal data declaration ****************************/
+extern uint8_t _flash_eeprom_start[];
+
+/********************** internal functions declaration ***********************/
+static uint32_t sim_rcc_apb_shift(uint32_t ppre, uint32_t pos);
+static bool sim_flash_op(void);
+
+/********************** internal data definition *****************************/
+static sim_uart_tx_t sim_uart_tx_dta;
+static sim_uart_rx_t sim_uart_rx_dta;
+static uint32_t sim_flash_op_qty;		// Program & erase operations left before the cut
+
+/********************** external data declaration ****************************/
+__IO uint32_t uwTick;
+
+FILE *sim_uart_out;
+void (*sim_uart_tap)(const uint8_t *data, uint32_t len);
+
+/********************** internal functions definition ************************/
+/* PPREx: 0xx HCLK, 100 /2, 101 /4, 110 /8, 111 /16 */
+static uint32_t sim_rcc_apb_shift(uint32_t ppre, uint32_t pos) {
+	uint32_t div = (ppre >> pos) & 0x7ul;
+
+	return (0ul != (div & 0x4ul)) ? ((div & 0x3ul) + 1ul) : 0ul;
+}
+
+/* Power still there for one more program or erase */
+static bool sim_flash_op(void) {
+	if (0ul == sim_flash_op_qty)
+		return false;
+
+	if (SIM_FLASH_OP_ALL != sim_flash_op_qty)
+		sim_flash_op_qty--;
+
+	return true;
+}
+
+/********************** external functions definition ************************/
+/* Reset values: inputs pulled up (buttons released, DIP switches off),
+ * flash locked, clock tree of SystemClock_Config() */
+void sim_hal_init(void) {
+	uint32_t index;
+
+	for (index = 0; SIM_GPIO_PORT_QTY > index; index++)
+		SIM_GPIO_PORT(index)->IDR = 0xFFFFul;
+
+	FLASH->CR = FLASH_CR_LOCK;
+	RCC->CFGR = RCC_CFGR_SWS_PLL | RCC_CFGR_PPRE1_DIV2 | RCC_CFGR_PPRE2_DIV1;
+
+	sim_flash_op_qty = SIM_FLASH_OP_ALL;
+
+	uwTick = 0ul;
+	sim_uart_out = stdout;
+	sim_uart_tap = NULL;
+	memset(&sim_uart_tx_dta, 0, sizeof(sim_uart_tx_dta));
+	memset(&sim_uart_rx_dta, 0, sizeof(sim_uart_rx_dta));
+}
+
+/* Level seen by HAL_GPIO_ReadPin(), pins are not connected to the outputs */
+void sim_gpio_input(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state) {
+	if (GPIO_PIN_SET == state)
+		port->IDR |= pin;
+	else
+		port->IDR &= ~(uint32_t)pin;
+}
+
+GPIO_PinState sim_gpio_output(GPIO_TypeDef *port, uint16_t pin) {
+	return (0ul != (port->ODR & pin)) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+/* Apply the BSRR and BRR stores to ODR, set wins as on the port */
+void sim_gpio_sync(void) {
+	GPIO_TypeDef *port;
+	uint32_t index;
+
+	for (index = 0; SIM_GPIO_PORT_QTY > index; index++) {
+		port = SIM_GPIO_PORT(index);
+
+		if ((0ul == port->BSRR) && (0ul == port->BRR))
+			continue;
+
+		port->ODR = ((port->ODR & ~(port->BRR | (port->BSRR >> SIM_GPIO_BSRR_RESET_POS))) | port->BSRR) & 0xFFFFul;
+		port->BSRR = 0ul;
+		port->BRR = 0ul;
+	}
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init) {
+	(void)GPIOx;
+	(void)GPIO_Init;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+	return (0ul != (GPIOx->IDR & GPIO_Pin)) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {
+	sim_gpio_sync();
+
+	if (GPIO_PIN_RESET != PinState)
+		GPIOx->ODR |= GPIO_Pin;
+	else
+		GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+	sim_gpio_sync();
+
+	GPIOx->ODR ^= GPIO_Pin;
+}
+
+void HAL_IncTick(void) {
+	uwTick++;
+}
+
+uint32_t HAL_GetTick(void) {
+	return uwTick;
+}
+
+void HAL_SYSTICK_IRQHandler(void) {
+	HAL_SYSTICK_Callback();
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void) {
+	return SystemCoreClock >> sim_rcc_apb_shift(RCC->CFGR, RCC_CFGR_PPRE1_Pos);
+}
+
+uint32_t HAL_RCC_GetPCLK2Freq(void) {
+	return SystemCoreClock >> sim_rcc_apb_shift(RCC->CFGR, RCC_CFGR_PPRE2_Pos);
+}
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void) {
+	FLASH->CR &= ~FLASH_CR_LOCK;
+
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void) {
+	FLASH->CR |= FLASH_CR_LOCK;
+
+	return HAL_OK;
+}
+
+/* Half-word by half-word as the controller does: only an erased half-word
+ * may be programmed, except with 0x0000 */
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data) {
+	volatile uint16_t *p_half = (volatile uint16_t *)(uintptr_t)Address;
+	uint32_t qty = 1ul << (TypeProgram - FLASH_TYPEPROGRAM_HALFWORD);
+	uint32_t index;
+
+	if ((0ul != (FLASH->CR & FLASH_CR_LOCK)) || (0ul != (Address & 1ul))
+			|| (FLASH_BASE > Address) || ((FLASH_BASE + SIM_CPU_FLASH_SIZE) < (Address + (qty * 2ul))))
+		return HAL_ERROR;
+
+	if (false == sim_flash_op())
+		return HAL_ERROR;
+
+	for (index = 0; qty > index; index++) {
+		if ((SIM_FLASH_ERASED != p_half[index]) && (0u != (uint16_t)Data)) {
+			FLASH->SR |= FLASH_SR_PGERR;
+			return HAL_ERROR;
+		}
+
+		p_half[index] = (uint16_t)Data;
+		Data >>= 16;
+	}
+
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError) {
+	*PageError = 0xFFFFFFFFul;
+
+	if ((0ul != (FLASH->CR & FLASH_CR_LOCK)) || (FLASH_TYPEERASE_PAGES != pEraseInit->TypeErase)
+			|| (0ul != (pEraseInit->PageAddress % FLASH_PAGE_SIZE)) || (FLASH_BASE > pEraseInit->PageAddress)
+			|| ((FLASH_BASE + SIM_CPU_FLASH_SIZE) < (pEraseInit->PageAddress + (pEraseInit->NbPages * FLASH_PAGE_SIZE)))) {
+		*PageError = pEraseInit->PageAddress;
+		return HAL_ERROR;
+	}
+
+	if (false == sim_flash_op()) {
+		*PageError = pEraseInit->PageAddress;
+		return HAL_ERROR;
+	}
+
+	memset((void *)(uintptr_t)pEraseInit->PageAddress, 0xFF, pEraseInit->NbPages * FLASH_PAGE_SIZE);
+
+	return HAL_OK;
+}
+
+/* Infinitely fast line: the transfer completes as soon as the core takes
+ * the interrupt */
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size) {
+	if (0ul != sim_uart_tx_dta.len)
+		return HAL_BUSY;
+
+	if (0u == Size)
+		return HAL_ERROR;
+
+	sim_uart_tx_dta.huart = huart;
+	sim_uart_tx_dta.data = pData;
+	sim_uart_tx_dta.len = Size;
+
+	sim_cpu_irq_raise(SIM_CPU_IRQ_UART_TX);
+
+	return HAL_OK;
+}
+
+/* Circular DMA, as configured by HAL_UART_MspInit() */
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size) {
+	if (0u == Size)
+		return HAL_ERROR;
+
+	sim_uart_rx_dta.huart = huart;
+	sim_uart_rx_dta.buffer = pData;
+	sim_uart_rx_dta.size = Size;
+	sim_uart_rx_dta.pos = 0ul;
+
+	return HAL_OK;
+}
+
+/* Bytes arriving back to back, then the line goes idle */
+void sim_uart_rx(const uint8_t *data, uint32_t len) {
+	if (NULL == sim_uart_rx_dta.huart)
+		return;
+
+	while (0ul < len--) {
+		sim_uart_rx_dta.buffer[sim_uart_rx_dta.pos] = *data++;
+		sim_uart_rx_dta.pos = (sim_uart_rx_dta.pos + 1ul) % sim_uart_rx_dta.size;
+	}
+
+	sim_cpu_irq_raise(SIM_CPU_IRQ_UART_RX);
+}
+
+/* DMA1 channel 7 transfer complete */
+void sim_uart_irq_tx(void) {
+	UART_HandleTypeDef *huart = sim_uart_tx_dta.huart;
+
+	if (0ul == sim_uart_tx_dta.len)
+		return;
+
+	if (NULL != sim_uart_out)
+		fwrite(sim_uart_tx_dta.data, 1, sim_uart_tx_dta.len, sim_uart_out);
+
+	if (NULL != sim_uart_tap)
+		sim_uart_tap(sim_uart_tx_dta.data, sim_uart_tx_dta.len);
+
+	sim_uart_tx_dta.len = 0ul;
+
+	HAL_UART_TxCpltCallback(huart);
+}
+
+/* USART2 IDLE line */
+void sim_uart_irq_rx(void) {
+	if (NULL == sim_uart_rx_dta.huart)
+		return;
+
+	HAL_UARTEx_RxEventCallback(sim_uart_rx_dta.huart, (uint16_t)sim_uart_rx_dta.pos);
+}
+
+/* EEPROM pages of the linker script, raw image */
+bool sim_flash_load(const char *path) {
+	FILE *p_file = fopen(path, "rb");
+	size_t size;
+
+	if (NULL == p_file)
+		return false;
+
+	size = fread(_flash_eeprom_start, 1, SIM_FLASH_EEPROM_SIZE, p_file);
+	fclose(p_file);
+
+	return (SIM_FLASH_EEPROM_SIZE == size);
+}
+
+/* Power cut after op_qty more program or erase operations: the following
+ * ones fail and leave the flash untouched. SIM_FLASH_OP_ALL restores it */
+void sim_flash_cut(uint32_t op_qty) {
+	sim_flash_op_qty = op_qty;
+}
+
+bool sim_flash_save(const char *path) {
+	FILE *p_file = fopen(path, "wb");
+	size_t size;
+
+	if (NULL == p_file)
+		return false;
+
+	size = fwrite(_flash_eeprom_start, 1, SIM_FLASH_EEPROM_SIZE, p_file);
+
+	return (0 == fclose(p_file)) && (SIM_FLASH_EEPROM_SIZE == size);
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,198 @@
+/*
+ * sim_main.c
+ *
+ */
+
+/* Host driver: runs the firmware against the simulated board as fast as
+ * the host allows, one SysTick period per loop.
+ *
+ *   sim/build/app_sim [-t ms] [-p ms] [-e eeprom.bin] [-c command] [-q]
+ *                     [-r trace] [-o capture] [-g golden] [-b]
+ *
+ *   -t  virtual time to run, default one hour
+ *   -p  pack period of the built-in line, 0 leaves the inputs idle
+ *   -e  EEPROM image, loaded before app_init() and saved at the end
+ *   -c  command line sent on USART2 at the end, answered within the
+ *       following SIM_MAIN_REPLY_MS (see task_command)
+ *   -q  drop the USART2 output (logger and command replies)
+ *   -r  input trace replayed instead of the built-in line, run up to its
+ *       last item unless -t is given (see sim_replay.h)
+ *   -o  capture of inputs, queue events and outputs written to a file
+ *   -g  capture compared with a golden file, exit status 1 on a difference
+ *   -b  task & queue benchmarks (bench.h) after app_init(), instead of the
+ *       run, in host TSC ticks. The task logs come first, decode them:
+ *       sim/build/app_sim -b | python3 tools/logger_decode.py sim/build/app_sim - | grep ^bench
+ *
+ * USART2 output goes to stdout, LOGGER_LOGD records included:
+ *   sim/build/app_sim | python3 tools/logger_decode.py sim/build/app_sim - */
+
+/********************** inclusions *******************************************/
+#include <time.h>
+#include <unistd.h>
+
+/* Project includes. */
+#include "main.h"
+
+/* Application & Tasks includes. */
+#include "board.h"
+#include "app.h"
+#include "bench.h"
+#include "sim_cpu.h"
+#include "sim_hal.h"
+#include "sim_board.h"
+#include "sim_replay.h"
+
+/********************** macros and definitions *******************************/
+#define SIM_MAIN_TIME_MS_DEF		3600000ul	// One hour of line operation
+#define SIM_MAIN_PACK_PERIOD_DEF	2000ul
+#define SIM_MAIN_PACK_PRESS_MS		100ul		// Longer than the debounce
+#define SIM_MAIN_REPLY_MS			10ul
+
+/********************** internal data declaration ****************************/
+
+/********************** internal functions declaration ***********************/
+static void sim_main_line(uint32_t time_ms, uint32_t period_ms);
+static void sim_main_usage(const char *p_name);
+
+/********************** internal data definition *****************************/
+
+/********************** external data declaration ****************************/
+
+/********************** internal functions definition ************************/
+/* Line under control: packs arrive every period and leave half a period
+ * later, each sensor pressed long enough to pass the debounce */
+static void sim_main_line(uint32_t time_ms, uint32_t period_ms) {
+	uint32_t phase = time_ms % period_ms;
+
+	if (0ul == time_ms)
+		sim_gpio_input(DIP_CTRL_SYST_PORT, DIP_CTRL_SYST_PIN, DIP_CTRL_SYST_PRESSED);
+
+	if (0ul == phase)
+		sim_gpio_input(BTN_PACK_IN_PORT, BTN_PACK_IN_PIN, BTN_PACK_IN_PRESSED);
+	else if (SIM_MAIN_PACK_PRESS_MS == phase)
+		sim_gpio_input(BTN_PACK_IN_PORT, BTN_PACK_IN_PIN, BTN_PACK_IN_HOVER);
+
+	if ((period_ms / 2ul) == phase)
+		sim_gpio_input(BTN_PACK_OUT_PORT, BTN_PACK_OUT_PIN, BTN_PACK_OUT_PRESSED);
+	else if (((period_ms / 2ul) + SIM_MAIN_PACK_PRESS_MS) == phase)
+		sim_gpio_input(BTN_PACK_OUT_PORT, BTN_PACK_OUT_PIN, BTN_PACK_OUT_HOVER);
+}
+
+static void sim_main_usage(const char *p_name) {
+	fprintf(stderr, "usage: %s [-t ms] [-p ms] [-e eeprom.bin] [-c command] [-q]"
+			" [-r trace] [-o capture] [-g golden] [-b]\n", p_name);
+	exit(EXIT_FAILURE);
+}
+
+/********************** external functions definition ************************/
+int main(int argc, char *argv[]) {
+	uint32_t time_ms = SIM_MAIN_TIME_MS_DEF;
+	uint32_t period_ms = SIM_MAIN_PACK_PERIOD_DEF;
+	const char *p_eeprom = NULL;
+	const char *p_command = NULL;
+	const char *p_trace = NULL;
+	const char *p_capture = NULL;
+	const char *p_golden = NULL;
+	bool time_set = false;
+	bool quiet = false;
+	bool bench = false;
+	bool match = true;
+	struct timespec start;
+	struct timespec stop;
+	double host_s;
+	uint32_t tick;
+	int option;
+
+	while (-1 != (option = getopt(argc, argv, "t:p:e:c:qr:o:g:b"))) {
+		switch (option) {
+			case 't': time_ms = (uint32_t)strtoul(optarg, NULL, 0); time_set = true; break;
+			case 'p': period_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'e': p_eeprom = optarg; break;
+			case 'c': p_command = optarg; break;
+			case 'q': quiet = true; break;
+			case 'r': p_trace = optarg; break;
+			case 'o': p_capture = optarg; break;
+			case 'g': p_golden = optarg; break;
+			case 'b': bench = true; break;
+			default: sim_main_usage(argv[0]);
+		}
+	}
+
+	if ((0ul != period_ms) && ((2ul * SIM_MAIN_PACK_PRESS_MS) >= (period_ms / 2ul))) {
+		fprintf(stderr, "sim: pack period too short\n");
+		return EXIT_FAILURE;
+	}
+
+	if (NULL != p_trace) {
+		if (false == sim_replay_load(p_trace))
+			return EXIT_FAILURE;
+
+		period_ms = 0ul;
+
+		if (false == time_set)
+			time_ms = sim_replay_end() + 1ul;
+	}
+
+	sim_board_init();
+
+	if (((NULL != p_capture) || (NULL != p_golden)) && (false == sim_replay_capture_start())) {
+		fprintf(stderr, "sim: no capture file\n");
+		return EXIT_FAILURE;
+	}
+
+	if (quiet)
+		sim_uart_out = NULL;
+
+	if ((NULL != p_eeprom) && (false == sim_flash_load(p_eeprom)))
+		fprintf(stderr, "sim: %s not loaded, blank EEPROM\n", p_eeprom);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	app_init();
+
+	if (bench) {
+		bench_run();
+		bench_dump();
+		time_ms = 0ul;
+	}
+
+	for (tick = 0; time_ms > tick; tick++) {
+		if (0ul != period_ms)
+			sim_main_line(tick, period_ms);
+
+		sim_replay_apply(tick);
+		sim_board_tick();
+		sim_replay_capture(tick);
+	}
+
+	if (NULL != p_command) {
+		sim_uart_rx((const uint8_t *)p_command, (uint32_t)strlen(p_command));
+		sim_uart_rx((const uint8_t *)"\n", 1ul);
+
+		for (tick = 0; SIM_MAIN_REPLY_MS > tick; tick++)
+			sim_board_tick();
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+
+	if (NULL != sim_uart_out)
+		fflush(sim_uart_out);
+
+	if ((NULL != p_eeprom) && (false == sim_flash_save(p_eeprom)))
+		fprintf(stderr, "sim: %s not saved\n", p_eeprom);
+
+	if ((NULL != p_capture) && (false == sim_replay_capture_save(p_capture)))
+		fprintf(stderr, "sim: %s not saved\n", p_capture);
+
+	if (NULL != p_golden)
+		match = sim_replay_capture_compare(p_golden);
+
+	host_s = (double)(stop.tv_sec - start.tv_sec) + ((double)(stop.tv_nsec - start.tv_nsec) * 1e-9);
+
+	fprintf(stderr, "sim: %lu ms in %.3f s (x%.0f), %lu ticks run\n", (unsigned long)time_ms, host_s,
+			(0.0 < host_s) ? ((double)time_ms / (host_s * 1000.0)) : 0.0, (unsigned long)g_app_cnt);
+
+	return match ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/********************** end of file ******************************************/
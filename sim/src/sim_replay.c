@@ -0,0 +1,440 @@
+/*
+ * sim_replay.c
+ *
+ */
+
+/* Input trace replay and capture of what the application did with it, see
+ * sim_replay.h for both formats. Queue events come from the trace recorder
+ * (trace.h), drained after every tick: it must stay enabled for the run.
+ * USART2 text is taken through sim_uart_tap, the deferred log records in
+ * it are skipped */
+
+/********************** inclusions *******************************************/
+/* Project includes. */
+#include "task_shared_params.h"
+#include "main.h"
+
+/* Demo includes. */
+#include "logger.h"
+#include "trace.h"
+
+/* Application & Tasks includes. */
+#include "board.h"
+#include "sim_hal.h"
+#include "sim_replay.h"
+
+/********************** macros and definitions *******************************/
+#define SIM_REPLAY_LINE_MAXLEN		256ul
+#define SIM_REPLAY_ITEM_QTY_INI		256ul
+#define SIM_REPLAY_UART_MAXLEN		1024ul		// Text of a tick not yet captured
+
+typedef enum sim_replay_type {SIM_REPLAY_TYPE_INPUT,
+							  SIM_REPLAY_TYPE_CMD,
+							  SIM_REPLAY_TYPE_END} sim_replay_type_t;
+
+typedef struct {
+	uint32_t			time_ms;
+	sim_replay_type_t	type;
+	uint32_t			index;		// Input
+	uint32_t			value;		// Input: 1 pressed / on
+	char				cmd[SIM_REPLAY_CMD_MAXLEN];
+} sim_replay_item_t;
+
+typedef struct {
+	const char			*name;
+	GPIO_TypeDef		*port;
+	uint16_t			pin;
+	GPIO_PinState		active;
+} sim_replay_pin_t;
+
+/********************** internal data declaration ****************************/
+extern task_shared_params_t shared_params[SYST_LANE_QTY];
+
+/********************** internal functions declaration ***********************/
+static bool sim_replay_parse(sim_replay_item_t *p_item, char *p_line, uint32_t line);
+static void sim_replay_capture_trace(uint32_t time_ms);
+static void sim_replay_capture_params(uint32_t time_ms);
+static void sim_replay_capture_uart(uint32_t time_ms);
+static void sim_replay_uart(const uint8_t *data, uint32_t len);
+
+/********************** internal data definition *****************************/
+static const sim_replay_pin_t sim_replay_input_list[] = {
+	{"pack_in",		BTN_PACK_IN_PORT,			BTN_PACK_IN_PIN,			BTN_PACK_IN_PRESSED},
+	{"pack_out",	BTN_PACK_OUT_PORT,			BTN_PACK_OUT_PIN,			BTN_PACK_OUT_PRESSED},
+	{"setup",		DIP_NORMAL_OR_SETUP_PORT,	DIP_NORMAL_OR_SETUP_PIN,	DIP_NORMAL_OR_SETUP_PRESSED},
+	{"infrared",	DIP_INFRARED_PORT,			DIP_INFRARED_PIN,			DIP_INFRARED_PRESSED},
+	{"ctrl",		DIP_CTRL_SYST_PORT,			DIP_CTRL_SYST_PIN,			DIP_CTRL_SYST_PRESSED},
+	{"enter",		BTN_SETUP_ENTER_PORT,		BTN_SETUP_ENTER_PIN,		BTN_SETUP_ENTER_PRESSED},
+	{"next",		BTN_SETUP_NEXT_PORT,		BTN_SETUP_NEXT_PIN,			BTN_SETUP_NEXT_PRESSED},
+	{"escape",		BTN_SETUP_ESCAPE_PORT,		BTN_SETUP_ESCAPE_PIN,		BTN_SETUP_ESCAPE_PRESSED}
+};
+
+#define SIM_REPLAY_INPUT_QTY	(sizeof(sim_replay_input_list)/sizeof(sim_replay_pin_t))
+
+static const sim_replay_pin_t sim_replay_output_list[] = {
+	{"led_a",		LED_A_PORT,			LED_A_PIN,			LED_A_ON},
+	{"packs_0",		LED_PACKS_0_PORT,	LED_PACKS_0_PIN,	LED_BAR_ON},
+	{"packs_1",		LED_PACKS_1_PORT,	LED_PACKS_1_PIN,	LED_BAR_ON},
+	{"packs_2",		LED_PACKS_2_PORT,	LED_PACKS_2_PIN,	LED_BAR_ON},
+	{"packs_3",		LED_PACKS_3_PORT,	LED_PACKS_3_PIN,	LED_BAR_ON},
+	{"speed_0",		LED_SPEED_0_PORT,	LED_SPEED_0_PIN,	LED_BAR_ON},
+	{"speed_1",		LED_SPEED_1_PORT,	LED_SPEED_1_PIN,	LED_BAR_ON},
+	{"speed_2",		LED_SPEED_2_PORT,	LED_SPEED_2_PIN,	LED_BAR_ON},
+	{"speed_3",		LED_SPEED_3_PORT,	LED_SPEED_3_PIN,	LED_BAR_ON}
+};
+
+#define SIM_REPLAY_OUTPUT_QTY	(sizeof(sim_replay_output_list)/sizeof(sim_replay_pin_t))
+
+/* Indexed by trace_queue_t */
+static const char * const sim_replay_queue_name[] = {
+	"normal", "setup", "actuator", "bar"
+};
+
+#define SIM_REPLAY_QUEUE_QTY	(sizeof(sim_replay_queue_name)/sizeof(const char *))
+
+static sim_replay_item_t *sim_replay_item_list;
+static uint32_t sim_replay_item_qty;
+static uint32_t sim_replay_item_next;
+static uint32_t sim_replay_end_ms;
+
+static FILE *sim_replay_capture_file;
+static uint32_t sim_replay_trace_tail;
+static uint32_t sim_replay_output_level;	// Bit per output, 1: active
+static bool sim_replay_output_valid;
+static task_shared_params_dta_t sim_replay_params[SYST_LANE_QTY];
+
+static char sim_replay_uart_text[SIM_REPLAY_UART_MAXLEN];
+static uint32_t sim_replay_uart_len;
+static uint32_t sim_replay_uart_skip;		// Bytes of a deferred record still to come
+static bool sim_replay_uart_qty_next;		// The byte after LOGGER_DEFERRED_SYNC
+
+/********************** external data declaration ****************************/
+
+/********************** internal functions definition ************************/
+static bool sim_replay_parse(sim_replay_item_t *p_item, char *p_line, uint32_t line) {
+	char *p_end;
+	char *p_word;
+	uint32_t index;
+
+	p_item->time_ms = (uint32_t)strtoul(p_line, &p_end, 0);
+	p_word = strtok(p_end, " \t\r\n");
+
+	if ((p_end == p_line) || (NULL == p_word)) {
+		fprintf(stderr, "sim: replay line %lu: <ms> <item> expected\n", (unsigned long)line);
+		return false;
+	}
+
+	if (0 == strcmp("end", p_word)) {
+		p_item->type = SIM_REPLAY_TYPE_END;
+		return true;
+	}
+
+	if (0 == strcmp("cmd", p_word)) {
+		p_word = strtok(NULL, "\r\n");
+
+		if ((NULL == p_word) || (SIM_REPLAY_CMD_MAXLEN <= strlen(p_word))) {
+			fprintf(stderr, "sim: replay line %lu: command missing or too long\n", (unsigned long)line);
+			return false;
+		}
+
+		p_item->type = SIM_REPLAY_TYPE_CMD;
+		strcpy(p_item->cmd, p_word);
+		return true;
+	}
+
+	for (index = 0; SIM_REPLAY_INPUT_QTY > index; index++) {
+		if (0 == strcmp(sim_replay_input_list[index].name, p_word))
+			break;
+	}
+
+	p_word = strtok(NULL, " \t\r\n");
+
+	if ((SIM_REPLAY_INPUT_QTY == index) || (NULL == p_word) || ((0 != strcmp("0", p_word)) && (0 != strcmp("1", p_word)))) {
+		fprintf(stderr, "sim: replay line %lu: <input> <1|0> expected\n", (unsigned long)line);
+		return false;
+	}
+
+	p_item->type = SIM_REPLAY_TYPE_INPUT;
+	p_item->index = index;
+	p_item->value = (uint32_t)('1' == *p_word);
+
+	return true;
+}
+
+/* Queue puts and gets recorded since the last tick */
+static void sim_replay_capture_trace(uint32_t time_ms) {
+	const trace_entry_t *p_entry;
+	uint32_t head = trace_recorder.head;
+
+	if (TRACE_CONFIG_SIZE < (head - sim_replay_trace_tail)) {
+		fprintf(sim_replay_capture_file, "%lu overrun %lu\n", (unsigned long)time_ms,
+				(unsigned long)(head - sim_replay_trace_tail - TRACE_CONFIG_SIZE));
+		sim_replay_trace_tail = head - TRACE_CONFIG_SIZE;
+	}
+
+	for (; head != sim_replay_trace_tail; sim_replay_trace_tail++) {
+		p_entry = &trace_recorder.entry[sim_replay_trace_tail % TRACE_CONFIG_SIZE];
+
+		if (((TRACE_EV_QUEUE_PUT != p_entry->type) && (TRACE_EV_QUEUE_GET != p_entry->type))
+				|| (SIM_REPLAY_QUEUE_QTY <= p_entry->id))
+			continue;
+
+		fprintf(sim_replay_capture_file, "%lu %s %s %u %u\n", (unsigned long)time_ms,
+				(TRACE_EV_QUEUE_PUT == p_entry->type) ? "put" : "get", sim_replay_queue_name[p_entry->id],
+				(unsigned int)(p_entry->arg >> 8), (unsigned int)(p_entry->arg & 0xFFu));
+	}
+}
+
+/* Lanes whose published params changed since the last tick */
+static void sim_replay_capture_params(uint32_t time_ms) {
+	task_shared_params_dta_t dta;
+	uint32_t lane;
+
+	for (lane = 0; SYST_LANE_QTY > lane; lane++) {
+		snapshot_task_shared_params(&shared_params[lane], &dta);
+
+		if (sim_replay_output_valid && (sim_replay_params[lane].pack_rate == dta.pack_rate)
+				&& (sim_replay_params[lane].waiting_time == dta.waiting_time))
+			continue;
+
+		sim_replay_params[lane] = dta;
+		fprintf(sim_replay_capture_file, "%lu params %lu %lu %lu\n", (unsigned long)time_ms, (unsigned long)lane,
+				(unsigned long)dta.pack_rate, (unsigned long)dta.waiting_time);
+	}
+}
+
+/* Text lines sent since the last tick. A line still open waits for the
+ * rest of it, unless the buffer is full or the logger ring has been sent
+ * out whole (a message cut at LOGGER_CONFIG_MAXLEN loses its newline) */
+static void sim_replay_capture_uart(uint32_t time_ms) {
+	char *p_line = sim_replay_uart_text;
+	char *p_end;
+	uint32_t left = sim_replay_uart_len;
+	uint32_t len;
+
+	while (NULL != (p_end = memchr(p_line, '\n', left))) {
+		len = (uint32_t)(p_end - p_line);
+
+		if (0ul != len)
+			fprintf(sim_replay_capture_file, "%lu uart %.*s\n", (unsigned long)time_ms, (int)len, p_line);
+
+		left -= len + 1ul;
+		p_line = p_end + 1;
+	}
+
+	if ((0ul != left) && ((SIM_REPLAY_UART_MAXLEN == left) || (LOGGER_CONFIG_RING_SIZE == logger_uart_room()))) {
+		fprintf(sim_replay_capture_file, "%lu uart %.*s\n", (unsigned long)time_ms, (int)left, p_line);
+		left = 0ul;
+	}
+
+	memmove(sim_replay_uart_text, p_line, left);
+	sim_replay_uart_len = left;
+}
+
+/* sim_uart_tap: the text is kept, a deferred record (LOGGER_DEFERRED_SYNC,
+ * qty, 16 bit id, qty arguments) is skipped, its id follows the build */
+static void sim_replay_uart(const uint8_t *data, uint32_t len) {
+	uint8_t byte;
+
+	while (0ul < len--) {
+		byte = *data++;
+
+		if (0ul < sim_replay_uart_skip) {
+			sim_replay_uart_skip--;
+		}
+		else if (sim_replay_uart_qty_next) {
+			sim_replay_uart_qty_next = false;
+			sim_replay_uart_skip = (LOGGER_DEFERRED_HEADER_LEN - 2ul) + ((uint32_t)byte * sizeof(uint32_t));
+		}
+		else if (LOGGER_DEFERRED_SYNC == byte) {
+			sim_replay_uart_qty_next = true;
+		}
+		else if (('\r' != byte) && (SIM_REPLAY_UART_MAXLEN > sim_replay_uart_len)) {
+			sim_replay_uart_text[sim_replay_uart_len++] = (char)byte;
+		}
+	}
+}
+
+/********************** external functions definition ************************/
+bool sim_replay_load(const char *path) {
+	FILE *p_file = fopen(path, "r");
+	char text[SIM_REPLAY_LINE_MAXLEN];
+	sim_replay_item_t item;
+	uint32_t item_max = 0ul;
+	uint32_t line = 0ul;
+	bool b_ok = true;
+	char *p_line;
+
+	if (NULL == p_file) {
+		fprintf(stderr, "sim: cannot open %s\n", path);
+		return false;
+	}
+
+	sim_replay_item_qty = 0ul;
+	sim_replay_item_next = 0ul;
+	sim_replay_end_ms = 0ul;
+
+	while (NULL != fgets(text, sizeof(text), p_file)) {
+		line++;
+		p_line = text + strspn(text, " \t");
+
+		if (('#' == *p_line) || ('\0' == p_line[strspn(p_line, " \t\r\n")]))
+			continue;
+
+		memset(&item, 0, sizeof(item));
+
+		if (false == sim_replay_parse(&item, p_line, line)) {
+			b_ok = false;
+			break;
+		}
+
+		if (item.time_ms < sim_replay_end_ms) {
+			fprintf(stderr, "sim: replay line %lu: time goes back\n", (unsigned long)line);
+			b_ok = false;
+			break;
+		}
+
+		sim_replay_end_ms = item.time_ms;
+
+		if (SIM_REPLAY_TYPE_END == item.type)
+			continue;
+
+		/* realloc, malloc is counted as the application's (sim_board.c) */
+		if (item_max == sim_replay_item_qty) {
+			item_max = (0ul == item_max) ? SIM_REPLAY_ITEM_QTY_INI : (2ul * item_max);
+			sim_replay_item_list = realloc(sim_replay_item_list, item_max * sizeof(sim_replay_item_t));
+
+			if (NULL == sim_replay_item_list) {
+				b_ok = false;
+				break;
+			}
+		}
+
+		sim_replay_item_list[sim_replay_item_qty++] = item;
+	}
+
+	fclose(p_file);
+
+	return b_ok;
+}
+
+uint32_t sim_replay_end(void) {
+	return sim_replay_end_ms;
+}
+
+/* Items due at this tick, before its SysTick */
+void sim_replay_apply(uint32_t time_ms) {
+	const sim_replay_item_t *p_item;
+	const sim_replay_pin_t *p_pin;
+
+	while ((sim_replay_item_qty > sim_replay_item_next) && (time_ms == sim_replay_item_list[sim_replay_item_next].time_ms)) {
+		p_item = &sim_replay_item_list[sim_replay_item_next++];
+
+		if (SIM_REPLAY_TYPE_CMD == p_item->type) {
+			sim_uart_rx((const uint8_t *)p_item->cmd, (uint32_t)strlen(p_item->cmd));
+			sim_uart_rx((const uint8_t *)"\n", 1ul);
+			continue;
+		}
+
+		p_pin = &sim_replay_input_list[p_item->index];
+		sim_gpio_input(p_pin->port, p_pin->pin,
+					   (0ul != p_item->value) ? p_pin->active : ((GPIO_PIN_SET == p_pin->active) ? GPIO_PIN_RESET : GPIO_PIN_SET));
+
+		if (NULL != sim_replay_capture_file)
+			fprintf(sim_replay_capture_file, "%lu in %s %lu\n", (unsigned long)time_ms, p_pin->name, (unsigned long)p_item->value);
+	}
+}
+
+/* Before app_init(), so the events of the task inits are kept (ms 0) */
+bool sim_replay_capture_start(void) {
+	sim_replay_capture_file = tmpfile();
+	sim_replay_trace_tail = 0ul;
+	sim_replay_output_level = 0ul;
+	sim_replay_output_valid = false;
+	sim_replay_uart_len = 0ul;
+	sim_replay_uart_skip = 0ul;
+	sim_replay_uart_qty_next = false;
+	sim_uart_tap = sim_replay_uart;
+
+	return (NULL != sim_replay_capture_file);
+}
+
+/* After the tick: its queue events, the outputs and params that changed,
+ * then the text sent */
+void sim_replay_capture(uint32_t time_ms) {
+	const sim_replay_pin_t *p_pin;
+	uint32_t level;
+	uint32_t index;
+
+	if (NULL == sim_replay_capture_file)
+		return;
+
+	sim_replay_capture_trace(time_ms);
+
+	for (index = 0; SIM_REPLAY_OUTPUT_QTY > index; index++) {
+		p_pin = &sim_replay_output_list[index];
+		level = (uint32_t)(p_pin->active == sim_gpio_output(p_pin->port, p_pin->pin));
+
+		if (sim_replay_output_valid && (level == ((sim_replay_output_level >> index) & 1ul)))
+			continue;
+
+		sim_replay_output_level = (sim_replay_output_level & ~(1ul << index)) | (level << index);
+		fprintf(sim_replay_capture_file, "%lu out %s %lu\n", (unsigned long)time_ms, p_pin->name, (unsigned long)level);
+	}
+
+	sim_replay_capture_params(time_ms);
+	sim_replay_capture_uart(time_ms);
+
+	sim_replay_output_valid = true;
+}
+
+bool sim_replay_capture_save(const char *path) {
+	FILE *p_file;
+	char text[SIM_REPLAY_LINE_MAXLEN];
+
+	if ((NULL == sim_replay_capture_file) || (NULL == (p_file = fopen(path, "w"))))
+		return false;
+
+	rewind(sim_replay_capture_file);
+
+	while (NULL != fgets(text, sizeof(text), sim_replay_capture_file))
+		fputs(text, p_file);
+
+	return (0 == fclose(p_file));
+}
+
+/* Line by line, the first difference is reported */
+bool sim_replay_capture_compare(const char *path) {
+	FILE *p_file;
+	char golden[SIM_REPLAY_LINE_MAXLEN];
+	char capture[SIM_REPLAY_LINE_MAXLEN];
+	bool b_golden;
+	bool b_capture;
+	uint32_t line = 0ul;
+
+	if ((NULL == sim_replay_capture_file) || (NULL == (p_file = fopen(path, "r")))) {
+		fprintf(stderr, "sim: cannot open %s\n", path);
+		return false;
+	}
+
+	rewind(sim_replay_capture_file);
+
+	do {
+		line++;
+		b_golden = (NULL != fgets(golden, sizeof(golden), p_file));
+		b_capture = (NULL != fgets(capture, sizeof(capture), sim_replay_capture_file));
+
+		if ((b_golden != b_capture) || (b_golden && (0 != strcmp(golden, capture)))) {
+			fprintf(stderr, "sim: %s line %lu differs\n- %s+ %s", path, (unsigned long)line,
+					b_golden ? golden : "(end)\n", b_capture ? capture : "(end)\n");
+			fclose(p_file);
+			return false;
+		}
+	} while (b_golden);
+
+	fclose(p_file);
+
+	return true;
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,339 @@
+/*
+ * test_flash_eeprom.c
+ *
+ */
+
+/* Host tests of flash_eeprom.c over the flash of sim_hal.c. A reset is a
+ * new flash_eeprom_init() on the flash as it was left, power cuts come from
+ * sim_flash_cut(): the operations after the cut fail and write nothing.
+ *
+ *   make -C sim test
+ *   sim/build/test_flash_eeprom */
+
+/********************** inclusions *******************************************/
+/* Project includes. */
+#include "task_shared_params.h"
+#include "main.h"
+
+/* Demo includes. */
+#include "flash_eeprom.h"
+
+/* Application & Tasks includes. */
+#include "sim_cpu.h"
+#include "sim_hal.h"
+
+/********************** macros and definitions *******************************/
+/* Private to flash_eeprom.c, the layout is checked from outside */
+#define TEST_PAGE_ERASED			0xFFFFu
+#define TEST_PAGE_RECEIVE			0xEEEEu
+#define TEST_PAGE_ACTIVE			0x0000u
+#define TEST_RECORD_ERASED			0xFFFFu
+#define TEST_RECORD_QTY				((FLASH_PAGE_SIZE / sizeof(flash_eeprom_record_t)) - 1ul)
+
+/* Flash operations of a rotation: erase, header, a record per lane, then
+ * the header goes ACTIVE and the old page is erased */
+#define TEST_ROTATE_OP_RECEIVE		(2ul + SYST_LANE_QTY)
+#define TEST_ROTATE_OP_ACTIVE		(TEST_ROTATE_OP_RECEIVE + 1ul)
+
+#define TEST_CHECK(cond)			test_check((cond), #cond, __LINE__)
+
+typedef struct {
+	const char	*name;
+	void		(*run)(void);
+} test_case_t;
+
+/********************** internal data declaration ****************************/
+extern uint8_t _flash_eeprom_start[];
+
+/********************** internal functions declaration ***********************/
+static void test_check(bool cond, const char *p_cond, int line);
+static const flash_eeprom_header_t *test_header(uint32_t page);
+static flash_eeprom_record_t *test_record(uint32_t page, uint32_t index);
+static task_shared_params_dta_t test_params(uint32_t index);
+static bool test_read_is(uint32_t lane, const task_shared_params_dta_t *p_dta);
+static void test_boot(void);
+static void test_fill(uint32_t qty);
+
+static void test_blank_format(void);
+static void test_append_restore(void);
+static void test_rotation(void);
+static void test_torn_record(void);
+static void test_reset_receive(void);
+static void test_rotate_retry(void);
+static void test_reset_active(void);
+
+/********************** internal data definition *****************************/
+static const test_case_t test_case_list[] = {
+	{"blank_format",	test_blank_format},
+	{"append_restore",	test_append_restore},
+	{"rotation",		test_rotation},
+	{"torn_record",		test_torn_record},
+	{"reset_receive",	test_reset_receive},
+	{"rotate_retry",	test_rotate_retry},
+	{"reset_active",	test_reset_active}
+};
+
+#define TEST_CASE_QTY	(sizeof(test_case_list)/sizeof(test_case_t))
+
+static const char *p_test_case;
+static uint32_t test_check_cnt;
+static uint32_t test_fail_cnt;
+
+/********************** external data declaration ****************************/
+
+/********************** internal functions definition ************************/
+static void test_check(bool cond, const char *p_cond, int line) {
+	test_check_cnt++;
+
+	if (cond)
+		return;
+
+	test_fail_cnt++;
+	fprintf(stderr, "%s:%d: %s: %s\n", __FILE__, line, p_test_case, p_cond);
+}
+
+static const flash_eeprom_header_t *test_header(uint32_t page) {
+	return (const flash_eeprom_header_t *)(_flash_eeprom_start + (page * FLASH_PAGE_SIZE));
+}
+
+static flash_eeprom_record_t *test_record(uint32_t page, uint32_t index) {
+	return (flash_eeprom_record_t *)(_flash_eeprom_start + (page * FLASH_PAGE_SIZE)
+									 + ((index + 1ul) * sizeof(flash_eeprom_record_t)));
+}
+
+/* A different value set for every index, each one in range */
+static task_shared_params_dta_t test_params(uint32_t index) {
+	task_shared_params_dta_t dta;
+
+	dta.pack_rate = DEL_SYST_MIN_PACK_RATE + (index % DEL_SYST_MAX_PACKS);
+	dta.waiting_time = DEL_SYST_MIN_WAITING_TIME + ((index / DEL_SYST_MAX_PACKS) % DEL_SYST_MAX_WAITING_TIME);
+
+	return dta;
+}
+
+static bool test_read_is(uint32_t lane, const task_shared_params_dta_t *p_dta) {
+	task_shared_params_dta_t dta;
+
+	return (true == flash_eeprom_read(lane, &dta))
+			&& (p_dta->pack_rate == dta.pack_rate) && (p_dta->waiting_time == dta.waiting_time);
+}
+
+/* Power on with erased flash */
+static void test_boot(void) {
+	sim_cpu_init();
+	sim_hal_init();
+}
+
+/* qty writes to lane 0, test_params(0) first */
+static void test_fill(uint32_t qty) {
+	task_shared_params_dta_t dta;
+	uint32_t index;
+
+	for (index = 0; qty > index; index++) {
+		dta = test_params(index);
+		TEST_CHECK(true == flash_eeprom_write(SYST_LANE_0, &dta));
+	}
+}
+
+/* Blank device: the first page is formatted, nothing to read */
+static void test_blank_format(void) {
+	task_shared_params_dta_t dta;
+	uint32_t lane;
+
+	test_boot();
+
+	TEST_CHECK(true == flash_eeprom_init());
+	TEST_CHECK(TEST_PAGE_ACTIVE == test_header(0)->state);
+	TEST_CHECK(0u == test_header(0)->generation);
+	TEST_CHECK(TEST_RECORD_ERASED == test_record(0, 0)->magic);
+	TEST_CHECK(TEST_PAGE_ERASED == test_header(1)->state);
+
+	for (lane = 0; SYST_LANE_QTY > lane; lane++)
+		TEST_CHECK(false == flash_eeprom_read(lane, &dta));
+
+	/* Unformattable storage: no page, nothing read or written */
+	test_boot();
+	sim_flash_cut(0ul);
+
+	TEST_CHECK(false == flash_eeprom_init());
+	TEST_CHECK(TEST_PAGE_ERASED == test_header(0)->state);
+
+	sim_flash_cut(SIM_FLASH_OP_ALL);
+	dta = test_params(0);
+	TEST_CHECK(false == flash_eeprom_write(SYST_LANE_0, &dta));
+	TEST_CHECK(false == flash_eeprom_read(SYST_LANE_0, &dta));
+}
+
+/* Records append in order, the latest one is restored after a reset and an
+ * unchanged value is not written again */
+static void test_append_restore(void) {
+	task_shared_params_dta_t dta;
+
+	test_boot();
+	TEST_CHECK(true == flash_eeprom_init());
+
+	test_fill(3ul);
+	TEST_CHECK(TEST_RECORD_ERASED != test_record(0, 2)->magic);
+	TEST_CHECK(TEST_RECORD_ERASED == test_record(0, 3)->magic);
+
+	TEST_CHECK(true == flash_eeprom_init());
+	dta = test_params(2);
+	TEST_CHECK(true == test_read_is(SYST_LANE_0, &dta));
+
+	TEST_CHECK(true == flash_eeprom_write(SYST_LANE_0, &dta));
+	TEST_CHECK(TEST_RECORD_ERASED == test_record(0, 3)->magic);
+}
+
+/* Past TEST_RECORD_QTY writes the latest values move to the next page, the
+ * full one is erased, and the ring comes back to the first page */
+static void test_rotation(void) {
+	task_shared_params_dta_t dta;
+
+	test_boot();
+	TEST_CHECK(true == flash_eeprom_init());
+
+	test_fill(TEST_RECORD_QTY + 1ul);
+	TEST_CHECK(TEST_PAGE_ERASED == test_header(0)->state);
+	TEST_CHECK(TEST_PAGE_ACTIVE == test_header(1)->state);
+	TEST_CHECK(1u == test_header(1)->generation);
+
+	TEST_CHECK(true == flash_eeprom_init());
+	dta = test_params(TEST_RECORD_QTY);
+	TEST_CHECK(true == test_read_is(SYST_LANE_0, &dta));
+
+	test_fill(TEST_RECORD_QTY);
+	TEST_CHECK(TEST_PAGE_ACTIVE == test_header(0)->state);
+	TEST_CHECK(2u == test_header(0)->generation);
+	TEST_CHECK(TEST_PAGE_ERASED == test_header(1)->state);
+
+	TEST_CHECK(true == flash_eeprom_init());
+	dta = test_params(TEST_RECORD_QTY - 1ul);
+	TEST_CHECK(true == test_read_is(SYST_LANE_0, &dta));
+}
+
+/* A record cut before its CRC, or with a bad one, is skipped: the previous
+ * record of the lane is restored */
+static void test_torn_record(void) {
+	task_shared_params_dta_t dta;
+
+	test_boot();
+	TEST_CHECK(true == flash_eeprom_init());
+	test_fill(2ul);
+
+	test_record(0, 1)->crc = TEST_RECORD_ERASED;
+	TEST_CHECK(true == flash_eeprom_init());
+	dta = test_params(0);
+	TEST_CHECK(true == test_read_is(SYST_LANE_0, &dta));
+
+	test_record(0, 0)->crc ^= 0x0100u;
+	TEST_CHECK(true == flash_eeprom_init());
+	TEST_CHECK(false == flash_eeprom_read(SYST_LANE_0, &dta));
+
+	/* Appends go on after the torn records */
+	dta = test_params(5);
+	TEST_CHECK(true == flash_eeprom_write(SYST_LANE_0, &dta));
+	TEST_CHECK(TEST_RECORD_ERASED != test_record(0, 2)->magic);
+	TEST_CHECK(true == flash_eeprom_init());
+	TEST_CHECK(true == test_read_is(SYST_LANE_0, &dta));
+}
+
+/* Reset with the new page still RECEIVE: the full page stays the active
+ * one, and the next write rotates again */
+static void test_reset_receive(void) {
+	task_shared_params_dta_t dta;
+
+	test_boot();
+	TEST_CHECK(true == flash_eeprom_init());
+	test_fill(TEST_RECORD_QTY);
+
+	sim_flash_cut(TEST_ROTATE_OP_RECEIVE);
+	dta = test_params(TEST_RECORD_QTY);
+	TEST_CHECK(false == flash_eeprom_write(SYST_LANE_0, &dta));
+	TEST_CHECK(TEST_PAGE_ACTIVE == test_header(0)->state);
+	TEST_CHECK(TEST_PAGE_RECEIVE == test_header(1)->state);
+
+	sim_flash_cut(SIM_FLASH_OP_ALL);
+	TEST_CHECK(true == flash_eeprom_init());
+	dta = test_params(TEST_RECORD_QTY - 1ul);
+	TEST_CHECK(true == test_read_is(SYST_LANE_0, &dta));
+
+	dta = test_params(TEST_RECORD_QTY);
+	TEST_CHECK(true == flash_eeprom_write(SYST_LANE_0, &dta));
+	TEST_CHECK(TEST_PAGE_ERASED == test_header(0)->state);
+	TEST_CHECK(TEST_PAGE_ACTIVE == test_header(1)->state);
+
+	TEST_CHECK(true == flash_eeprom_init());
+	TEST_CHECK(true == test_read_is(SYST_LANE_0, &dta));
+}
+
+/* A rotation that failed before ACTIVE leaves the module on the full page:
+ * the next write, with no reset, rotates again instead of appending to the
+ * RECEIVE page */
+static void test_rotate_retry(void) {
+	task_shared_params_dta_t dta;
+
+	test_boot();
+	TEST_CHECK(true == flash_eeprom_init());
+	test_fill(TEST_RECORD_QTY);
+
+	sim_flash_cut(TEST_ROTATE_OP_RECEIVE);
+	dta = test_params(TEST_RECORD_QTY);
+	TEST_CHECK(false == flash_eeprom_write(SYST_LANE_0, &dta));
+
+	sim_flash_cut(SIM_FLASH_OP_ALL);
+	TEST_CHECK(true == flash_eeprom_write(SYST_LANE_0, &dta));
+	TEST_CHECK(TEST_PAGE_ACTIVE == test_header(1)->state);
+
+	TEST_CHECK(true == flash_eeprom_init());
+	TEST_CHECK(true == test_read_is(SYST_LANE_0, &dta));
+}
+
+/* Reset with both pages ACTIVE: the newest generation wins, and the stale
+ * page is the next one erased */
+static void test_reset_active(void) {
+	task_shared_params_dta_t dta;
+
+	test_boot();
+	TEST_CHECK(true == flash_eeprom_init());
+	test_fill(TEST_RECORD_QTY);
+
+	sim_flash_cut(TEST_ROTATE_OP_ACTIVE);
+	dta = test_params(TEST_RECORD_QTY);
+	TEST_CHECK(false == flash_eeprom_write(SYST_LANE_0, &dta));
+	TEST_CHECK(TEST_PAGE_ACTIVE == test_header(0)->state);
+	TEST_CHECK(TEST_PAGE_ACTIVE == test_header(1)->state);
+
+	sim_flash_cut(SIM_FLASH_OP_ALL);
+	TEST_CHECK(true == flash_eeprom_init());
+	dta = test_params(TEST_RECORD_QTY - 1ul);
+	TEST_CHECK(true == test_read_is(SYST_LANE_0, &dta));
+
+	/* Appended to the newest page, the stale one is left for the next
+	 * rotation */
+	dta = test_params(TEST_RECORD_QTY);
+	TEST_CHECK(true == flash_eeprom_write(SYST_LANE_0, &dta));
+	TEST_CHECK(TEST_RECORD_ERASED != test_record(1, SYST_LANE_QTY)->magic);
+	TEST_CHECK(true == flash_eeprom_init());
+	TEST_CHECK(true == test_read_is(SYST_LANE_0, &dta));
+
+	test_fill(TEST_RECORD_QTY);
+	TEST_CHECK(TEST_PAGE_ACTIVE == test_header(0)->state);
+	TEST_CHECK(2u == test_header(0)->generation);
+	TEST_CHECK(TEST_PAGE_ERASED == test_header(1)->state);
+}
+
+/********************** external functions definition ************************/
+int main(void) {
+	uint32_t index;
+
+	for (index = 0; TEST_CASE_QTY > index; index++) {
+		p_test_case = test_case_list[index].name;
+		test_case_list[index].run();
+	}
+
+	printf("test_flash_eeprom: %lu checks, %lu failed\n", (unsigned long)test_check_cnt, (unsigned long)test_fail_cnt);
+
+	return (0ul == test_fail_cnt) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/********************** end of file ******************************************/
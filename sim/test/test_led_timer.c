@@ -0,0 +1,229 @@
+/*
+ * test_led_timer.c
+ *
+ */
+
+/* Host tests of led_timer.c over the timer registers of sim_cpu.c. No timer
+ * runs in the simulation: the tests check what each call programs, and
+ * which timers and channels led_timer_init() takes. The owners are kept
+ * over the whole run, a timer keeps the channel of the first case using it.
+ *
+ *   make -C sim test
+ *   sim/build/test_led_timer */
+
+/********************** inclusions *******************************************/
+/* Project includes. */
+#include "main.h"
+
+/* Demo includes. */
+#include "led_timer.h"
+
+/* Application & Tasks includes. */
+#include "sim_cpu.h"
+#include "sim_hal.h"
+
+/********************** macros and definitions *******************************/
+/* Private to led_timer.c, the modes are checked from outside */
+#define TEST_OCM_TOGGLE				0x3ul
+#define TEST_OCM_FORCE_OFF			0x4ul
+#define TEST_OCM_FORCE_ON			0x5ul
+#define TEST_OCM_PWM2				0x7ul
+
+/* sim_hal_init() leaves APB1 at HCLK / 2 and APB2 at HCLK, both timer
+ * kernel clocks run at HCLK */
+#define TEST_TIM_CLK				SystemCoreClock
+
+#define TEST_PIN					GPIO_PIN_0
+
+#define TEST_CHECK(cond)			test_check((cond), #cond, __LINE__)
+
+typedef struct {
+	const char	*name;
+	void		(*run)(void);
+} test_case_t;
+
+/********************** internal data declaration ****************************/
+
+/********************** internal functions declaration ***********************/
+static void test_check(bool cond, const char *p_cond, int line);
+static uint32_t test_ocm(TIM_TypeDef *tim, uint32_t channel);
+static uint32_t test_ccr(TIM_TypeDef *tim, uint32_t channel);
+static void test_boot(void);
+
+static void test_init_parked(void);
+static void test_blink(void);
+static void test_pulse(void);
+static void test_force(void);
+static void test_one_led_per_timer(void);
+static void test_bad_timer(void);
+
+/********************** internal data definition *****************************/
+static const test_case_t test_case_list[] = {
+	{"init_parked",			test_init_parked},
+	{"blink",				test_blink},
+	{"pulse",				test_pulse},
+	{"force",				test_force},
+	{"one_led_per_timer",	test_one_led_per_timer},
+	{"bad_timer",			test_bad_timer}
+};
+
+#define TEST_CASE_QTY	(sizeof(test_case_list)/sizeof(test_case_t))
+
+static const char *p_test_case;
+static uint32_t test_check_cnt;
+static uint32_t test_fail_cnt;
+
+/********************** external data declaration ****************************/
+
+/********************** internal functions definition ************************/
+static void test_check(bool cond, const char *p_cond, int line) {
+	test_check_cnt++;
+
+	if (cond)
+		return;
+
+	test_fail_cnt++;
+	fprintf(stderr, "%s:%d: %s: %s\n", __FILE__, line, p_test_case, p_cond);
+}
+
+/* Output compare mode of a channel (1..4) */
+static uint32_t test_ocm(TIM_TypeDef *tim, uint32_t channel) {
+	uint32_t ccmr = (2ul >= channel) ? tim->CCMR1 : tim->CCMR2;
+
+	return (ccmr >> ((((channel - 1ul) & 1ul) * 8ul) + 4ul)) & 0x7ul;
+}
+
+static uint32_t test_ccr(TIM_TypeDef *tim, uint32_t channel) {
+	return (&tim->CCR1)[channel - 1ul];
+}
+
+/* Power on, every timer register cleared */
+static void test_boot(void) {
+	sim_cpu_init();
+	sim_hal_init();
+}
+
+/* The channel output is enabled with the LED polarity and parked inactive,
+ * the counter stopped and clocked at LED_TIMER_CNT_FREQ_HZ */
+static void test_init_parked(void) {
+	test_boot();
+
+	TEST_CHECK(true == led_timer_init(TIM1, 3ul, GPIOA, TEST_PIN, false));
+	TEST_CHECK(0ul != (RCC->APB2ENR & RCC_APB2ENR_TIM1EN));
+	TEST_CHECK(0ul == (TIM1->CR1 & TIM_CR1_CEN));
+	TEST_CHECK((TEST_TIM_CLK / LED_TIMER_CNT_FREQ_HZ) == (TIM1->PSC + 1ul));
+	TEST_CHECK(TEST_OCM_FORCE_OFF == test_ocm(TIM1, 3ul));
+	TEST_CHECK(0ul != (TIM1->CCER & TIM_CCER_CC3E));
+	TEST_CHECK(0ul != (TIM1->CCER & TIM_CCER_CC3P));
+	TEST_CHECK(0ul != (TIM1->BDTR & TIM_BDTR_MOE));
+
+	/* Again with the same channel, as a second task_actuator_init() */
+	TEST_CHECK(true == led_timer_init(TIM1, 3ul, GPIOA, TEST_PIN, true));
+	TEST_CHECK(0ul == (TIM1->CCER & TIM_CCER_CC3P));
+}
+
+/* Free running toggle: the output flips on every match of CCR = ARR */
+static void test_blink(void) {
+	test_boot();
+
+	TEST_CHECK(true == led_timer_init(TIM2, 2ul, GPIOA, TEST_PIN, true));
+	TEST_CHECK((TEST_TIM_CLK / LED_TIMER_CNT_FREQ_HZ) == (TIM2->PSC + 1ul));
+
+	led_timer_blink(TIM2, 2ul, 500ul);
+	TEST_CHECK(((500ul * LED_TIMER_CNT_PER_MS) - 1ul) == TIM2->ARR);
+	TEST_CHECK(TIM2->ARR == test_ccr(TIM2, 2ul));
+	TEST_CHECK(TEST_OCM_TOGGLE == test_ocm(TIM2, 2ul));
+	TEST_CHECK(0ul == (TIM2->CR1 & TIM_CR1_OPM));
+	TEST_CHECK(true == led_timer_busy(TIM2));
+
+	/* Clamped to the 16 bit auto-reload */
+	led_timer_blink(TIM2, 2ul, LED_TIMER_MAX_MS + 1ul);
+	TEST_CHECK(((LED_TIMER_MAX_MS * LED_TIMER_CNT_PER_MS) - 1ul) == TIM2->ARR);
+}
+
+/* One pulse: PWM2 from CCR = 1 to the end of the period, then the counter
+ * stops by itself */
+static void test_pulse(void) {
+	test_boot();
+
+	TEST_CHECK(true == led_timer_init(TIM3, 1ul, GPIOA, TEST_PIN, true));
+
+	led_timer_pulse(TIM3, 1ul, 250ul);
+	TEST_CHECK((250ul * LED_TIMER_CNT_PER_MS) == TIM3->ARR);
+	TEST_CHECK(1ul == test_ccr(TIM3, 1ul));
+	TEST_CHECK(TEST_OCM_PWM2 == test_ocm(TIM3, 1ul));
+	TEST_CHECK(0ul != (TIM3->CR1 & TIM_CR1_OPM));
+	TEST_CHECK(true == led_timer_busy(TIM3));
+
+	/* The hardware clears CEN at the update event */
+	TIM3->CR1 &= ~TIM_CR1_CEN;
+	TEST_CHECK(false == led_timer_busy(TIM3));
+
+	/* A zero width is still a pulse */
+	led_timer_pulse(TIM3, 1ul, 0ul);
+	TEST_CHECK((1ul * LED_TIMER_CNT_PER_MS) == TIM3->ARR);
+}
+
+/* Forcing stops the counter, a blink left running would overwrite it */
+static void test_force(void) {
+	test_boot();
+
+	TEST_CHECK(true == led_timer_init(TIM4, 4ul, GPIOB, TEST_PIN, true));
+
+	led_timer_blink(TIM4, 4ul, 100ul);
+	led_timer_force(TIM4, 4ul, true);
+	TEST_CHECK(false == led_timer_busy(TIM4));
+	TEST_CHECK(TEST_OCM_FORCE_ON == test_ocm(TIM4, 4ul));
+
+	led_timer_force(TIM4, 4ul, false);
+	TEST_CHECK(TEST_OCM_FORCE_OFF == test_ocm(TIM4, 4ul));
+}
+
+/* A second channel of a timer in use is refused and leaves the timer and
+ * its owner alone */
+static void test_one_led_per_timer(void) {
+	uint32_t ccmr1;
+	uint32_t ccer;
+
+	test_boot();
+
+	TEST_CHECK(true == led_timer_init(TIM2, 2ul, GPIOA, TEST_PIN, true));
+	led_timer_blink(TIM2, 2ul, 200ul);
+	ccmr1 = TIM2->CCMR1;
+	ccer = TIM2->CCER;
+
+	TEST_CHECK(false == led_timer_init(TIM2, 1ul, GPIOA, TEST_PIN, false));
+	TEST_CHECK(ccmr1 == TIM2->CCMR1);
+	TEST_CHECK(ccer == TIM2->CCER);
+	TEST_CHECK(true == led_timer_busy(TIM2));
+
+	TEST_CHECK(true == led_timer_init(TIM2, 2ul, GPIOA, TEST_PIN, true));
+}
+
+/* Only TIM1..TIM4 and channels 1..4 */
+static void test_bad_timer(void) {
+	test_boot();
+
+	TEST_CHECK(false == led_timer_init((TIM_TypeDef *)USART2, 1ul, GPIOA, TEST_PIN, true));
+	TEST_CHECK(0ul == USART2->CR1);
+
+	TEST_CHECK(false == led_timer_init(TIM1, 0ul, GPIOA, TEST_PIN, true));
+	TEST_CHECK(false == led_timer_init(TIM1, 5ul, GPIOA, TEST_PIN, true));
+	TEST_CHECK(0ul == TIM1->CCER);
+}
+
+/********************** external functions definition ************************/
+int main(void) {
+	uint32_t index;
+
+	for (index = 0; TEST_CASE_QTY > index; index++) {
+		p_test_case = test_case_list[index].name;
+		test_case_list[index].run();
+	}
+
+	printf("test_led_timer: %lu checks, %lu failed\n", (unsigned long)test_check_cnt, (unsigned long)test_fail_cnt);
+
+	return (0ul == test_fail_cnt) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/********************** end of file ******************************************/
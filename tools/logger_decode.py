@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+#
+# logger_decode.py
+#
+# Rebuilds the text of the LOGGER_LOGD binary records from the USART2 byte
+# stream, using the format strings kept in the .logger_fmt section of the
+# firmware ELF. Plain text (LOGGER_LOG, command replies) is passed through.
+# Repeat summaries of LOGGER_LOGD_LIMIT are shown with the repeated message.
+#
+#   stty -F /dev/ttyACM0 115200 raw
+#   python3 tools/logger_decode.py Debug/tdse-tp2_02-model_integration.elf /dev/ttyACM0
+#   python3 tools/logger_decode.py firmware.elf capture.bin
+#   sim/build/app_sim | python3 tools/logger_decode.py sim/build/app_sim -
+#
+
+import re
+import struct
+import sys
+
+SYNC = 0xA5
+HEADER_LEN = 4
+FMT_SECTION = b".logger_fmt"
+
+# Must match LOGGER_DEFERRED_REPEAT_FMT in logger.h
+REPEAT_FMT = "  last message repeated %lu times (id %lu)\n"
+
+CONVERSION = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(hh|h|ll|l|z|j|t)?([diouxXcsp%])")
+
+
+def load_formats(elf_path):
+    with open(elf_path, "rb") as f:
+        elf = f.read()
+
+    if elf[:4] != b"\x7fELF" or elf[4] not in (1, 2):
+        sys.exit("%s: not an ELF file" % elf_path)
+
+    # ELF32 for the firmware, ELF64 for the host simulation (sim/)
+    if elf[4] == 1:
+        e_shoff, = struct.unpack_from("<I", elf, 0x20)
+        e_shentsize, e_shnum, e_shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+        sh_format = "<IIIIII"
+    else:
+        e_shoff, = struct.unpack_from("<Q", elf, 0x28)
+        e_shentsize, e_shnum, e_shstrndx = struct.unpack_from("<HHH", elf, 0x3A)
+        sh_format = "<IIQQQQ"
+
+    def section(index):
+        # name, type, flags, addr, offset, size
+        return struct.unpack_from(sh_format, elf, e_shoff + index * e_shentsize)
+
+    shstr_offset = section(e_shstrndx)[4]
+
+    for index in range(e_shnum):
+        name, _, _, addr, offset, size = section(index)
+        end = elf.index(b"\0", shstr_offset + name)
+        if elf[shstr_offset + name:end] == FMT_SECTION:
+            return addr, elf[offset:offset + size]
+
+    sys.exit("%s: no %s section" % (elf_path, FMT_SECTION.decode()))
+
+
+def render(fmt, args):
+    args = list(args)
+    out = []
+    pos = 0
+
+    for match in CONVERSION.finditer(fmt):
+        out.append(fmt[pos:match.start()])
+        pos = match.end()
+        flags, _, conv = match.groups()
+
+        if conv == "%":
+            out.append("%")
+            continue
+
+        value = args.pop(0) if args else 0
+
+        if conv in "di":
+            value = struct.unpack("<i", struct.pack("<I", value))[0]
+            out.append(("%" + flags + "d") % value)
+        elif conv in "ouxX":
+            out.append(("%" + flags + conv.replace("u", "d")) % value)
+        elif conv == "c":
+            out.append(chr(value & 0xFF))
+        else:
+            # %s and %p cannot be deferred, show the raw word
+            out.append("<0x%08x>" % value)
+
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+def decode(stream, base, formats, write):
+    text = bytearray()
+    last = {}
+
+    while True:
+        byte = stream.read(1)
+        if not byte:
+            break
+
+        if byte[0] != SYNC:
+            text += byte
+            if byte in b"\n\r":
+                write(text.decode("utf-8", "replace"))
+                text.clear()
+            continue
+
+        if text:
+            write(text.decode("utf-8", "replace"))
+            text.clear()
+
+        header = stream.read(HEADER_LEN - 1)
+        if len(header) < HEADER_LEN - 1:
+            break
+
+        qty = header[0]
+        msg_id, = struct.unpack("<H", header[1:3])
+        payload = stream.read(4 * qty)
+        if len(payload) < 4 * qty:
+            break
+
+        offset = msg_id - (base & 0xFFFF)
+        if offset < 0 or offset >= len(formats):
+            write("<unknown log id 0x%04x>\n" % msg_id)
+            continue
+
+        fmt = formats[offset:formats.index(b"\0", offset)].decode("utf-8", "replace")
+        args = struct.unpack("<%dI" % qty, payload)
+
+        if fmt == REPEAT_FMT and qty == 2:
+            message = last.get(args[1], "<id 0x%04x>" % args[1]).strip()
+            write("  last message repeated %d times: %s\n" % (args[0], message))
+            continue
+
+        last[msg_id] = render(fmt, args)
+        write(last[msg_id])
+
+    if text:
+        write(text.decode("utf-8", "replace"))
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit("usage: %s <firmware.elf> <capture file | tty | ->" % sys.argv[0])
+
+    base, formats = load_formats(sys.argv[1])
+
+    def write(s):
+        sys.stdout.write(s)
+        sys.stdout.flush()
+
+    if sys.argv[2] == "-":
+        decode(sys.stdin.buffer, base, formats, write)
+    else:
+        with open(sys.argv[2], "rb", buffering=0) as stream:
+            decode(stream, base, formats, write)
+
+
+if __name__ == "__main__":
+    main()
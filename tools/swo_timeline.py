@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+#
+# swo_timeline.py
+#
+# Turns a raw SWO capture (ITM packets, TPIU formatter off) into a task
+# timeline. The firmware writes the task index on ITM port 1 when a task
+# update starts and on port 2 when it ends (see app/inc/itm_trace.h), with
+# local timestamps enabled. Port 0 carries the logger (port 3 when logging
+# from interrupt handlers), each one can be saved apart and fed to
+# tools/logger_decode.py.
+#
+#   openocd ... -c "tpiu config internal swo.bin uart off 64000000"
+#   python3 tools/swo_timeline.py swo.bin
+#   python3 tools/swo_timeline.py swo.bin --log log.bin --cpu-hz 64000000
+#
+
+import argparse
+import sys
+
+PORT_LOG = 0
+PORT_TASK_START = 1
+PORT_TASK_STOP = 2
+PORT_LOG_ISR = 3
+
+# Order of task_cfg_list in app/src/app.c
+TASK_NAMES = ["sensor", "command", "normal", "setup", "actuator"]
+
+
+def packets(data):
+    """Yields ('ts', delta) and ('sw', port, payload) from the ITM stream."""
+    i = 0
+    n = len(data)
+
+    while i < n:
+        b = data[i]
+        i += 1
+
+        if b == 0x00 or b == 0x80 or b == 0x70:
+            # Sync bytes & overflow
+            continue
+
+        if (b & 0x0F) == 0x00:
+            # Local timestamp
+            if b & 0x80:
+                delta = 0
+                shift = 0
+                while i < n:
+                    c = data[i]
+                    i += 1
+                    delta |= (c & 0x7F) << shift
+                    shift += 7
+                    if not c & 0x80:
+                        break
+            else:
+                delta = (b >> 4) & 0x07
+            yield ("ts", delta)
+            continue
+
+        if (b & 0x0B) == 0x08 or (b & 0xDF) == 0x94:
+            # Extension & global timestamp packets
+            while i < n and (b & 0x80):
+                b = data[i]
+                i += 1
+            continue
+
+        size = {1: 1, 2: 2, 3: 4}.get(b & 0x03)
+        if size is None:
+            continue
+
+        payload = data[i:i + size]
+        i += size
+
+        if not b & 0x04:
+            yield ("sw", b >> 3, payload)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("capture")
+    parser.add_argument("--cpu-hz", type=float, default=64e6, help="ITM timestamp clock (SYSCLK)")
+    parser.add_argument("--log", help="write the port 0 bytes to this file")
+    parser.add_argument("--log-isr", help="write the port 3 bytes to this file")
+    args = parser.parse_args()
+
+    with open(args.capture, "rb") as f:
+        data = f.read()
+
+    us_per_tick = 1e6 / args.cpu_hz
+    time = 0
+    pending = []
+    events = []
+    log = bytearray()
+    log_isr = bytearray()
+
+    for packet in packets(data):
+        if packet[0] == "ts":
+            # A local timestamp closes the packets emitted before it
+            time += packet[1]
+            events += [(time, port, value) for port, value in pending]
+            pending = []
+            continue
+
+        _, port, payload = packet
+        if port == PORT_LOG:
+            log += payload
+        elif port == PORT_LOG_ISR:
+            log_isr += payload
+        elif port in (PORT_TASK_START, PORT_TASK_STOP):
+            pending.append((port, payload[0]))
+
+    events += [(time, port, value) for port, value in pending]
+
+    stats = {}
+    started = {}
+
+    for tick, port, task in events:
+        name = TASK_NAMES[task] if task < len(TASK_NAMES) else "task%d" % task
+        edge = "start" if port == PORT_TASK_START else "stop"
+        print("%12.3f us  %-10s %s" % (tick * us_per_tick, name, edge))
+
+        if port == PORT_TASK_START:
+            started[task] = tick
+        elif task in started:
+            duration = (tick - started.pop(task)) * us_per_tick
+            count, total, low, high = stats.get(name, (0, 0.0, duration, duration))
+            stats[name] = (count + 1, total + duration, min(low, duration), max(high, duration))
+
+    print()
+    print("%-10s %8s %10s %10s %10s" % ("task", "runs", "min us", "avg us", "max us"))
+    for name, (count, total, low, high) in stats.items():
+        print("%-10s %8d %10.3f %10.3f %10.3f" % (name, count, low, total / count, high))
+
+    if args.log:
+        with open(args.log, "wb") as f:
+            f.write(log)
+
+    if args.log_isr:
+        with open(args.log_isr, "wb") as f:
+            f.write(log_isr)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
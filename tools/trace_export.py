@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+#
+# trace_export.py
+#
+# Converts a RAM dump of the trace_recorder (app/inc/trace.h) into Chrome
+# trace JSON, to be opened in chrome://tracing or https://ui.perfetto.dev.
+# Stop the recorder first ("set trace 0" on the command channel), then dump
+# the symbol with the debugger:
+#
+#   arm-none-eabi-nm -S Debug/tdse-tp2_02-model_integration.elf | grep trace_recorder
+#   openocd ... -c "init; halt; dump_image trace.bin <address> <size>; resume; exit"
+#   python3 tools/trace_export.py trace.bin > trace.json
+#
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = 0x31435254
+HEADER = struct.Struct("<IIIII")   # magic, size, head, cpu_hz, enable
+ENTRY = struct.Struct("<IBBH")     # cycle_counter, type, id, arg
+
+EV_TICK, EV_TASK_BEGIN, EV_TASK_END, EV_QUEUE_PUT, EV_QUEUE_GET, EV_ISR_ENTER, EV_ISR_EXIT = range(7)
+
+# Order of task_cfg_list in app/src/app.c
+TASK_NAMES = ["sensor", "command", "normal", "setup", "actuator"]
+
+# trace_queue_t
+QUEUE_NAMES = ["normal", "setup", "actuator", "actuator_bar"]
+
+# Exception numbers (IPSR) of the traced handlers
+ISR_NAMES = {15: "SysTick", 32: "DMA1_Channel6", 33: "DMA1_Channel7", 54: "USART2", 56: "EXTI15_10"}
+
+TID_TICK, TID_TASKS, TID_QUEUES, TID_ISR = range(4)
+
+
+def entries(dump):
+    magic, size, head, cpu_hz, _ = HEADER.unpack_from(dump, 0)
+    if magic != MAGIC:
+        sys.exit("not a trace_recorder dump (magic 0x%08x)" % magic)
+    if len(dump) < HEADER.size + size * ENTRY.size:
+        sys.exit("dump too short for %d entries" % size)
+
+    qty = min(head, size)
+    first = head - qty
+    records = [ENTRY.unpack_from(dump, HEADER.size + ((first + i) % size) * ENTRY.size) for i in range(qty)]
+
+    # Entries are in time order, unwrap the 32 bit CYCCNT from the deltas
+    time = 0
+    previous = records[0][0] if records else 0
+    for cycle_counter, ev_type, ev_id, arg in records:
+        time += (cycle_counter - previous) & 0xFFFFFFFF
+        previous = cycle_counter
+        yield time * 1e6 / cpu_hz, ev_type, ev_id, arg
+
+
+def main():
+    parser = argparse.ArgumentParser(description="trace_recorder dump to Chrome trace JSON")
+    parser.add_argument("dump")
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as f:
+        dump = f.read()
+
+    events = [{"ph": "M", "pid": 0, "tid": tid, "name": "thread_name", "args": {"name": name}}
+              for tid, name in ((TID_TICK, "tick"), (TID_TASKS, "tasks"), (TID_QUEUES, "queues"), (TID_ISR, "isr"))]
+
+    for ts, ev_type, ev_id, arg in entries(dump):
+        event = {"pid": 0, "ts": ts}
+
+        if ev_type == EV_TICK:
+            event.update(ph="i", s="t", tid=TID_TICK, name="tick", args={"g_app_cnt": arg})
+        elif ev_type in (EV_TASK_BEGIN, EV_TASK_END):
+            name = TASK_NAMES[ev_id] if ev_id < len(TASK_NAMES) else "task%d" % ev_id
+            event.update(ph="B" if ev_type == EV_TASK_BEGIN else "E", tid=TID_TASKS, name=name)
+        elif ev_type in (EV_QUEUE_PUT, EV_QUEUE_GET):
+            name = QUEUE_NAMES[ev_id] if ev_id < len(QUEUE_NAMES) else "queue%d" % ev_id
+            edge = "put" if ev_type == EV_QUEUE_PUT else "get"
+            event.update(ph="i", s="t", tid=TID_QUEUES, name="%s %s" % (name, edge),
+                         args={"lane": arg >> 8, "event": arg & 0xFF})
+        elif ev_type in (EV_ISR_ENTER, EV_ISR_EXIT):
+            name = ISR_NAMES.get(ev_id, "exception%d" % ev_id)
+            event.update(ph="B" if ev_type == EV_ISR_ENTER else "E", tid=TID_ISR, name=name)
+        else:
+            continue
+
+        events.append(event)
+
+    json.dump({"traceEvents": events, "displayTimeUnit": "ns"}, sys.stdout, indent=1)
+    sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    sys.exit(main())